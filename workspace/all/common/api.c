@@ -7,10 +7,14 @@
 #include <fcntl.h>
 #include <unistd.h>
 #include <pthread.h>
+#include <stdatomic.h>
 
 #include <errno.h>
 #include <stdbool.h>
 #include <stdint.h>
+#include <time.h>
+#include <poll.h>
+#include <sys/eventfd.h>
 
 #include <msettings.h>
 
@@ -97,6 +101,7 @@ SDL_Surface* GFX_init(int mode) {
 	
 	gfx.screen = PLAT_initVideo();
 	gfx.vsync = VSYNC_STRICT;
+	TRACE_mark("GFX_init video");
 	gfx.mode = mode;
 	
 	RGB_WHITE		= SDL_MapRGB(gfx.screen->format, TRIAD_WHITE);
@@ -150,6 +155,7 @@ SDL_Surface* GFX_init(int mode) {
 	sprintf(asset_path, RES_PATH "/assets@%ix.png", FIXED_SCALE);
 	if (!exists(asset_path)) LOG_info("missing assets, you're about to segfault dummy!\n");
 	gfx.assets = IMG_Load(asset_path);
+	TRACE_mark("GFX_init assets");
 	
 	TTF_Init();
 	font.large 	= TTF_OpenFont(FONT_PATH, SCALE1(FONT_LARGE));
@@ -161,10 +167,13 @@ SDL_Surface* GFX_init(int mode) {
 	TTF_SetFontStyle(font.medium, TTF_STYLE_BOLD);
 	TTF_SetFontStyle(font.small, TTF_STYLE_BOLD);
 	TTF_SetFontStyle(font.tiny, TTF_STYLE_BOLD);
+	TRACE_mark("GFX_init fonts");
 	
 	return gfx.screen;
 }
+static void GFX_freeText(void);
 void GFX_quit(void) {
+	GFX_freeText();
 	TTF_CloseFont(font.large);
 	TTF_CloseFont(font.medium);
 	TTF_CloseFont(font.small);
@@ -173,6 +182,7 @@ void GFX_quit(void) {
 	SDL_FreeSurface(gfx.assets);
 	
 	GFX_freeAAScaler();
+	GFX_freeEffect();
 	
 	GFX_clearAll();
 
@@ -199,47 +209,445 @@ int GFX_hdmiChanged(void) {
 	return 1;
 }
 
-#define FRAME_BUDGET 17 // 60fps
-static uint32_t frame_start = 0;
+// frames are paced in microseconds on the monotonic clock (so setting
+// the date can't stall it) and the budget follows the content, eg. 50fps
+// PAL, 59.73fps GB or 75fps WonderSwan, instead of a fixed 17ms. content
+// close to the panel rate waits on vsync like before, slower content (or
+// vsync off) sleeps until an absolute deadline first so the error doesn't
+// pile up frame to frame
+static struct GFX_Pacing {
+	double fps;
+	double refresh; // of the panel
+	int matched; // fps close enough to refresh to just wait on vsync
+	int unpaced; // eg. fast forward
+	uint64_t budget; // per frame
+	uint64_t start; // of this frame
+	uint64_t deadline; // of the next present
+	uint64_t presented; // last present
+	double error; // smoothed distance between presents and the budget, in ms
+	double latency; // smoothed GFX_startFrame to present, in ms
+} pacing;
+
+static uint64_t pacingNow(void) {
+	struct timespec now;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return (uint64_t)now.tv_sec * 1000000 + now.tv_nsec / 1000;
+}
+static void pacingSleep(uint64_t until) {
+	struct timespec then = {until / 1000000, (until % 1000000) * 1000};
+	while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &then, NULL)==EINTR);
+}
+static void pacingPresented(void) {
+	uint64_t now = pacingNow();
+	if (pacing.presented && now-pacing.presented<pacing.budget*4) {
+		double error = fabs((double)(now - pacing.presented) - pacing.budget) / 1000;
+		pacing.error = pacing.error * 0.9 + error * 0.1;
+	}
+	pacing.presented = now;
+	
+	// start over after a stall (loading, sleep) instead of racing to catch up
+	if (!pacing.deadline || now>pacing.deadline+pacing.budget || now+pacing.budget<pacing.deadline) pacing.deadline = now;
+	pacing.deadline += pacing.budget;
+}
+
+void GFX_setTargetFPS(double fps) {
+	if (!pacing.refresh) pacing.refresh = PLAT_getRefreshRate();
+	pacing.unpaced = fps<0;
+	if (fps<=0) fps = pacing.refresh;
+	if (fps==pacing.fps) return;
+	
+	pacing.fps = fps;
+	pacing.budget = 1000000 / fps;
+	pacing.matched = fabs(fps - pacing.refresh) / pacing.refresh < 0.02; // eg. 59.73 or 60.1 on 60Hz, audio absorbs the drift
+	pacing.deadline = 0;
+	LOG_info("GFX_setTargetFPS(%f) refresh: %f budget: %ius %s\n", fps, pacing.refresh, (int)pacing.budget, pacing.matched ? "vsync" : "deadline");
+}
+double GFX_getFrameError(void) {
+	return pacing.error;
+}
+double GFX_getLatency(void) {
+	return pacing.latency;
+}
+
+SDL_Surface* GFX_setOutput(int hdmi) {
+	SDL_Surface* screen = PLAT_setOutput(hdmi);
+	if (!screen) return NULL;
+	gfx.screen = screen;
+	
+	// a tv doesn't necessarily refresh at the panel's rate
+	double fps = pacing.unpaced ? -1 : pacing.fps;
+	pacing.refresh = 0;
+	pacing.fps = 0;
+	pacing.latency = 0;
+	GFX_setTargetFPS(fps);
+	return screen;
+}
+
 void GFX_startFrame(void) {
-	frame_start = SDL_GetTicks();
+	if (!pacing.budget) GFX_setTargetFPS(0);
+	pacing.start = pacingNow();
 }
 
 void GFX_flip(SDL_Surface* screen) {
-	int should_vsync = (gfx.vsync!=VSYNC_OFF && (gfx.vsync==VSYNC_STRICT || frame_start==0 || SDL_GetTicks()-frame_start<FRAME_BUDGET));
+	if (!pacing.budget) GFX_setTargetFPS(0);
+	
+	uint64_t now = pacingNow();
+	int should_vsync = (gfx.vsync!=VSYNC_OFF && (gfx.vsync==VSYNC_STRICT || pacing.start==0 || now-pacing.start<pacing.budget));
+	if (!pacing.unpaced && (gfx.vsync==VSYNC_OFF || (!pacing.matched && pacing.fps<pacing.refresh))) {
+		// present on the content's clock, vsync can only round that to the panel
+		if (pacing.deadline && now<pacing.deadline) pacingSleep(pacing.deadline);
+	}
 	PLAT_flip(screen, should_vsync);
+	pacingPresented();
+	
+	// the part of input to photon we control, the tv (or panel) adds its own on top
+	if (pacing.start) {
+		double latency = (double)(pacing.presented - pacing.start) / 1000;
+		pacing.latency = pacing.latency ? pacing.latency * 0.9 + latency * 0.1 : latency;
+	}
 }
 void GFX_sync(void) {
-	uint32_t frame_duration = SDL_GetTicks() - frame_start;
-	if (gfx.vsync!=VSYNC_OFF) {
+	if (!pacing.budget) GFX_setTargetFPS(0);
+	
+	uint64_t now = pacingNow();
+	int64_t remaining = (int64_t)pacing.budget - (int64_t)(now - pacing.start);
+	if (gfx.vsync!=VSYNC_OFF && (pacing.matched || gfx.vsync==VSYNC_STRICT)) {
 		// this limiting condition helps SuperFX chip games
-		if (gfx.vsync==VSYNC_STRICT || frame_start==0 || frame_duration<FRAME_BUDGET) { // only wait if we're under frame budget
-			PLAT_vsync(FRAME_BUDGET-frame_duration);
+		if (gfx.vsync==VSYNC_STRICT || pacing.start==0 || remaining>0) { // only wait if we're under frame budget
+			PLAT_vsync(remaining / 1000);
 		}
 	}
-	else {
-		if (frame_duration<FRAME_BUDGET) SDL_Delay(FRAME_BUDGET-frame_duration);
+	else if (pacing.deadline) {
+		if (now<pacing.deadline) pacingSleep(pacing.deadline);
+	}
+	else if (remaining>0) pacingSleep(now + remaining);
+	pacingPresented();
+}
+
+///////////////////////////////
+
+// page flipping for the devices that scan out of ion pages, the page a
+// frame is drawn into is pointed at right away (the display latches it
+// on the next vblank) and a thread waiting on vblank retires the page it
+// replaced, so with three pages there's always a free one to draw into
+// and PLAT_flip only waits when it gets two frames ahead of the panel
+
+// a page pointed at between a vblank and the thread waking for it only
+// latches on the vblank after, so the page it replaces isn't drawn into
+// again until a vblank has passed since it stopped being shown for sure
+
+static struct GFX_Pages {
+	pthread_t thread;
+	pthread_mutex_t lock;
+	pthread_cond_t vblank;
+	void (*show)(int page);
+	int (*wait)(void);
+	int count;
+	int shown; // being scanned out
+	int pending; // pointed at but not latched yet, -1 for none
+	uint32_t pending_at; // vblanks when it was pointed at
+	int retiring; // replaced but maybe still scanned out, -1 for none
+	uint32_t retire_at; // vblanks after which it's free
+	int drawing;
+	int was_pending; // at the previous vblank
+	uint32_t vblanks;
+	double slack; // repeats owed to content slightly slower than the panel, eg. 59.73 on 60Hz
+	int missed; // vblanks that repeated a frame that should have been ready
+	atomic_int running;
+} pages = {
+	.lock = PTHREAD_MUTEX_INITIALIZER,
+	.vblank = PTHREAD_COND_INITIALIZER,
+	.pending = -1,
+	.retiring = -1,
+};
+
+static void* GFX_pageThread(void* arg) {
+	while (atomic_load(&pages.running)) {
+		if (pages.wait()<0) {
+			LOG_error("GFX_pageThread: wait for vblank failed %s\n", strerror(errno));
+			pacingSleep(pacingNow() + 1000000 / 60);
+		}
+		
+		pthread_mutex_lock(&pages.lock);
+		pages.vblanks += 1;
+		if (pages.retiring!=-1 && pages.vblanks>pages.retire_at) pages.retiring = -1;
+		if (pacing.matched && pacing.fps<pacing.refresh) {
+			pages.slack += 1 - pacing.fps / pacing.refresh;
+			if (pages.slack>2) pages.slack = 2;
+		}
+		
+		if (pages.pending!=-1) {
+			// shown at the latest on this vblank, or the next one if it was
+			// pointed at after this vblank but before we woke for it
+			pages.retiring = pages.shown;
+			pages.retire_at = pages.pending_at + 1;
+			pages.shown = pages.pending;
+			pages.pending = -1;
+			pages.was_pending = 1;
+		}
+		else {
+			// only count the first repeat of a stall and only when content
+			// is meant to present every vblank (not 50fps on 60Hz or menus),
+			// minus the repeats content a little slower than the panel owes
+			if (pages.was_pending && pacing.matched && !pacing.unpaced) {
+				if (pages.slack>=1) pages.slack -= 1;
+				else pages.missed += 1;
+			}
+			pages.was_pending = 0;
+		}
+		pthread_cond_broadcast(&pages.vblank);
+		pthread_mutex_unlock(&pages.lock);
+	}
+	return NULL;
+}
+
+int GFX_initPages(int count, void (*show)(int page), int (*wait)(void)) {
+	pages.count = count;
+	pages.show = show;
+	pages.wait = wait;
+	pages.shown = 0;
+	pages.pending = -1;
+	pages.drawing = 1;
+	pages.retiring = -1;
+	pages.slack = 0;
+	pages.missed = 0;
+	atomic_store(&pages.running, 1);
+	
+	show(pages.shown);
+	if (pthread_create(&pages.thread, NULL, GFX_pageThread, NULL)) {
+		LOG_error("GFX_initPages: unable to start vblank thread\n");
+		atomic_store(&pages.running, 0);
+	}
+	LOG_info("GFX_initPages(%i)\n", count);
+	return pages.drawing;
+}
+int GFX_flipPage(int sync) {
+	if (!atomic_load(&pages.running)) {
+		// no thread, plain double buffering
+		pages.show(pages.drawing);
+		if (sync) pages.wait();
+		pages.shown = pages.drawing;
+		pages.drawing = (pages.drawing + 1) % pages.count;
+		return pages.drawing;
 	}
+	
+	pthread_mutex_lock(&pages.lock);
+	// pointing at another page before the last one latched drops it,
+	// fine without vsync but otherwise give it its vblank
+	if (sync) {
+		while (pages.pending!=-1) pthread_cond_wait(&pages.vblank, &pages.lock);
+	}
+	pages.show(pages.drawing);
+	pages.pending = pages.drawing;
+	pages.pending_at = pages.vblanks;
+	
+	int next;
+	for (;;) {
+		for (int i=1; i<pages.count; i++) {
+			next = (pages.drawing + i) % pages.count;
+			if (next!=pages.shown && next!=pages.pending && next!=pages.retiring) break;
+			next = -1;
+		}
+		if (next!=-1) break;
+		pthread_cond_wait(&pages.vblank, &pages.lock); // for the retiring page to free up
+	}
+	pages.drawing = next;
+	pthread_mutex_unlock(&pages.lock);
+	return next;
+}
+void GFX_waitVblank(void) {
+	if (!atomic_load(&pages.running)) {
+		if (pages.wait) pages.wait();
+		return;
+	}
+	pthread_mutex_lock(&pages.lock);
+	uint32_t vblanks = pages.vblanks;
+	while (pages.vblanks==vblanks) pthread_cond_wait(&pages.vblank, &pages.lock);
+	pthread_mutex_unlock(&pages.lock);
+}
+void GFX_quitPages(void) {
+	if (!atomic_load(&pages.running)) return;
+	atomic_store(&pages.running, 0);
+	pthread_join(pages.thread, NULL); // after at most one more vblank
+	LOG_info("GFX_quitPages: missed %i vblanks\n", pages.missed);
+}
+int GFX_getMissedFrames(void) {
+	return pages.missed;
 }
 
 FALLBACK_IMPLEMENTATION int PLAT_supportsOverscan(void) { return 0; }
+#ifndef USES_SDL2_VIDEO
 FALLBACK_IMPLEMENTATION void PLAT_setEffectColor(int next_color) { }
+FALLBACK_IMPLEMENTATION double PLAT_getRefreshRate(void) { return 60; }
+FALLBACK_IMPLEMENTATION SDL_Surface* PLAT_setOutput(int hdmi) { return NULL; } // restart instead
+#endif
+
+// truncation used to chop a character and remeasure the whole string
+// until it fit, now the prefix that fits is found by binary search over
+// summed glyph advances and only confirmed (kerning aside the sum is
+// exact) with a measurement or two
+
+#define TEXT_FONT_COUNT 4 // GFX_Fonts
+static struct TextAdvances {
+	TTF_Font* font;
+	int advance[256]; // -1 until measured
+} advances[TEXT_FONT_COUNT];
+
+static uint32_t textNextChar(const char* str, int* len) { // utf8
+	uint8_t c = str[0];
+	int n = c<0x80 ? 1 : c<0xe0 ? 2 : c<0xf0 ? 3 : 4;
+	uint32_t code = n==1 ? c : c & (0x3f >> (n-1));
+	for (int i=1; i<n; i++) {
+		if ((str[i] & 0xc0)!=0x80) { // malformed, take the byte on its own
+			n = 1;
+			code = c;
+			break;
+		}
+		code = (code << 6) | (str[i] & 0x3f);
+	}
+	*len = n;
+	return code;
+}
+static int textAdvance(TTF_Font* font, uint32_t code) {
+	int advance = 0;
+	if (code>0xffff) return advance; // outside what TTF_GlyphMetrics takes
+	
+	struct TextAdvances* table = NULL;
+	if (code<256) {
+		for (int i=0; i<TEXT_FONT_COUNT; i++) {
+			if (advances[i].font==font || !advances[i].font) {
+				table = &advances[i];
+				break;
+			}
+		}
+		if (table && table->font!=font) {
+			table->font = font;
+			memset(table->advance, -1, sizeof(table->advance));
+		}
+		if (table && table->advance[code]!=-1) return table->advance[code];
+	}
+	
+	if (TTF_GlyphMetrics(font, code, NULL,NULL,NULL,NULL, &advance)) advance = 0;
+	if (table) table->advance[code] = advance;
+	return advance;
+}
+static void textEllipsize(const char* in_name, int len, char* out_name) {
+	memcpy(out_name, in_name, len);
+	strcpy(&out_name[len], "...");
+}
+static int textMeasure(TTF_Font* font, const char* in_name, int len, char* out_name, int padding) {
+	int text_width;
+	textEllipsize(in_name, len, out_name);
+	TTF_SizeUTF8(font, out_name, &text_width, NULL);
+	return text_width + padding;
+}
 
 int GFX_truncateText(TTF_Font* font, const char* in_name, char* out_name, int max_width, int padding) {
 	int text_width;
 	strcpy(out_name, in_name);
 	TTF_SizeUTF8(font, out_name, &text_width, NULL);
 	text_width += padding;
+	if (text_width<=max_width) return text_width;
+	
+	// character boundaries and the width up to each, like before
+	// at least the last 4 bytes make way for the ellipsis
+	int total = strlen(in_name) - 4;
+	if (total<0) total = 0;
+	int bounds[total+1];
+	int widths[total+1];
+	int count = 0;
+	int width = 0;
+	for (int i=0; i<=total; ) {
+		bounds[count] = i;
+		widths[count++] = width;
+		if (i==total) break;
+		int len;
+		width += textAdvance(font, textNextChar(&in_name[i], &len));
+		i += len;
+	}
 	
-	while (text_width>max_width) {
-		int len = strlen(out_name);
-		strcpy(&out_name[len-4], "...\0");
-		TTF_SizeUTF8(font, out_name, &text_width, NULL);
-		text_width += padding;
+	int ellipsis = textAdvance(font, '.') * 3;
+	int lo = 0;
+	int hi = count - 1;
+	while (lo<hi) {
+		int mid = (lo + hi + 1) / 2;
+		if (widths[mid]+ellipsis+padding<=max_width) lo = mid;
+		else hi = mid - 1;
 	}
 	
+	text_width = textMeasure(font, in_name, bounds[lo], out_name, padding);
+	while (lo>0 && text_width>max_width) {
+		text_width = textMeasure(font, in_name, bounds[--lo], out_name, padding);
+	}
+	while (lo+1<count && text_width<=max_width) {
+		int next_width = textMeasure(font, in_name, bounds[lo+1], out_name, padding);
+		if (next_width>max_width) {
+			textEllipsize(in_name, bounds[lo], out_name);
+			break;
+		}
+		text_width = next_width;
+		lo += 1;
+	}
 	return text_width;
 }
+
+// the menu list re-rendered every visible row (and each unique name
+// under it) on every dirty frame, scrolling mostly redraws the same
+// strings so keep the last few rendered rows around
+
+#define TEXT_CACHE_SIZE 32
+static struct TextCache {
+	SDL_Surface* surface;
+	TTF_Font* font;
+	char* str;
+	int max_width;
+	int padding;
+	uint32_t color;
+	int width;
+	uint32_t used;
+} text_cache[TEXT_CACHE_SIZE];
+static uint32_t text_clock;
+
+SDL_Surface* GFX_getText(TTF_Font* font, char* str, int max_width, int padding, SDL_Color color, int* text_width) {
+	uint32_t rgb = (color.r << 16) | (color.g << 8) | color.b;
+	struct TextCache* slot = &text_cache[0];
+	for (int i=0; i<TEXT_CACHE_SIZE; i++) {
+		struct TextCache* entry = &text_cache[i];
+		if (entry->str && entry->font==font && entry->max_width==max_width && entry->padding==padding && entry->color==rgb && exactMatch(entry->str, str)) {
+			entry->used = ++text_clock;
+			if (text_width) *text_width = entry->width;
+			return entry->surface;
+		}
+		if (!entry->str) slot = entry;
+		else if (slot->str && entry->used<slot->used) slot = entry;
+	}
+	
+	// evict the least recently used (or take an empty slot)
+	if (slot->surface) SDL_FreeSurface(slot->surface);
+	if (slot->str) free(slot->str);
+	
+	char truncated[MAX_PATH];
+	slot->width = GFX_truncateText(font, str, truncated, max_width, padding);
+	slot->surface = TTF_RenderUTF8_Blended(font, truncated, color);
+	slot->font = font;
+	slot->str = strdup(str);
+	slot->max_width = max_width;
+	slot->padding = padding;
+	slot->color = rgb;
+	slot->used = ++text_clock;
+	
+	if (text_width) *text_width = slot->width;
+	return slot->surface;
+}
+static void GFX_freeText(void) {
+	for (int i=0; i<TEXT_CACHE_SIZE; i++) {
+		struct TextCache* entry = &text_cache[i];
+		if (entry->surface) SDL_FreeSurface(entry->surface);
+		if (entry->str) free(entry->str);
+	}
+	memset(text_cache, 0, sizeof(text_cache));
+	memset(advances, 0, sizeof(advances));
+}
 int GFX_wrapText(TTF_Font* font, char* str, int max_width, int max_lines) {
 	if (!str) return 0;
 	
@@ -501,6 +909,658 @@ void GFX_freeAAScaler(void) {
 
 ///////////////////////////////
 
+// software effect stage for platforms that otherwise leave scaling
+// to the gpu, bakes the effect into an integer scaled copy of the
+// frame instead of blending a full screen overlay on top of it
+
+static struct FX_Buffer {
+	void* pixels;
+	int size;
+} fx_buffer;
+
+int GFX_effectType(int type, int scale) {
+	// lines work at 1x (every other row) but a grid needs room for its lines
+	if (scale<1 || (type==EFFECT_GRID && scale<2)) return EFFECT_NONE;
+	return type;
+}
+int GFX_effectScale(int type, int scale) {
+	if (GFX_effectType(type, scale)==EFFECT_NONE) return 1;
+	if (scale>SCALER_MAX_MUL) scale = SCALER_MAX_MUL;
+	return scale;
+}
+int GFX_applyEffect(GFX_Renderer* renderer, int type, int scale, int color, void** pixels, int* pitch) {
+	*pixels = renderer->src;
+	*pitch = renderer->src_p;
+	
+	type = GFX_effectType(type, scale);
+	if (type==EFFECT_NONE) return 1;
+	scale = GFX_effectScale(type, scale);
+	
+	int w = renderer->true_w * scale;
+	int h = renderer->true_h * scale;
+	int p = w * FIXED_BPP;
+	if (p*h>fx_buffer.size) {
+		free(fx_buffer.pixels);
+		fx_buffer.pixels = malloc(p*h);
+		fx_buffer.size = fx_buffer.pixels ? p*h : 0;
+		if (!fx_buffer.pixels) return 1;
+	}
+	
+	scaler_setEffectColor(color);
+	scaler_t scaler = scaler_lookup(FIXED_DEPTH, type, scale, scale);
+	scaler(renderer->src, fx_buffer.pixels, renderer->true_w, renderer->true_h, renderer->src_p, w, h, p);
+	
+	*pixels = fx_buffer.pixels;
+	*pitch = p;
+	return scale;
+}
+void GFX_freeEffect(void) {
+	if (fx_buffer.pixels) {
+		free(fx_buffer.pixels);
+		fx_buffer.pixels = NULL;
+		fx_buffer.size = 0;
+	}
+}
+
+#ifdef USE_SDL2
+///////////////////////////////
+
+// cores like dosbox, mame and some snes games bounce between a few
+// resolutions so keep the last few textures around instead of
+// destroying and recreating them on every switch
+
+#define TEXTURE_CACHE_SIZE 6
+static struct TextureCache {
+	SDL_Texture* texture;
+	int access;
+	int w;
+	int h;
+	int linear;
+	uint32_t used;
+} texture_cache[TEXTURE_CACHE_SIZE];
+static uint32_t texture_clock;
+
+SDL_Texture* GFX_getTexture(SDL_Renderer* renderer, int access, int w, int h, int linear) {
+	struct TextureCache* slot = &texture_cache[0];
+	for (int i=0; i<TEXTURE_CACHE_SIZE; i++) {
+		struct TextureCache* entry = &texture_cache[i];
+		if (entry->texture && entry->access==access && entry->w==w && entry->h==h && entry->linear==linear) {
+			entry->used = ++texture_clock;
+			return entry->texture;
+		}
+		if (!entry->texture) slot = entry;
+		else if (slot->texture && entry->used<slot->used) slot = entry;
+	}
+	
+	// evict the least recently used (or take an empty slot)
+	if (slot->texture) SDL_DestroyTexture(slot->texture);
+	
+	SDL_SetHintWithPriority(SDL_HINT_RENDER_SCALE_QUALITY, linear?"1":"0", SDL_HINT_OVERRIDE);
+	slot->texture = SDL_CreateTexture(renderer,SDL_PIXELFORMAT_RGB565, access, w,h);
+	slot->access = access;
+	slot->w = w;
+	slot->h = h;
+	slot->linear = linear;
+	slot->used = ++texture_clock;
+	
+	LOG_info("GFX_getTexture(%i,%i) access: %i linear: %i\n", w,h, access, linear);
+	return slot->texture;
+}
+
+// without an effect the frame goes straight from the core's buffer
+// into the texture with one SDL_UpdateTexture
+
+// with an effect the scaler can write into the locked texture instead
+// of an intermediate buffer, but some drivers lock slower than they
+// update, so both are timed for a few frames and the faster one kept
+
+// the winner depends only on frame size, effect and scale, so the last
+// few decisions are remembered and switching back skips the timing
+
+enum {
+	UPLOAD_LOCK,
+	UPLOAD_UPDATE,
+};
+#define UPLOAD_SAMPLES 16
+#define UPLOAD_CACHE_SIZE 8
+static struct Upload {
+	SDL_Texture* texture;
+	int type;
+	int scale;
+	int frames;
+	int mode;
+	uint64_t elapsed[2];
+} upload;
+static struct UploadCache {
+	int w;
+	int h;
+	int type;
+	int scale;
+	int mode;
+	uint32_t used;
+} upload_cache[UPLOAD_CACHE_SIZE];
+static uint32_t upload_clock;
+
+static struct UploadCache* uploadFind(int w, int h, int type, int scale) {
+	for (int i=0; i<UPLOAD_CACHE_SIZE; i++) {
+		struct UploadCache* entry = &upload_cache[i];
+		if (entry->used && entry->w==w && entry->h==h && entry->type==type && entry->scale==scale) {
+			entry->used = ++upload_clock;
+			return entry;
+		}
+	}
+	return NULL;
+}
+static void uploadRemember(int w, int h, int type, int scale, int mode) {
+	struct UploadCache* slot = &upload_cache[0];
+	for (int i=1; i<UPLOAD_CACHE_SIZE; i++) {
+		if (upload_cache[i].used<slot->used) slot = &upload_cache[i];
+	}
+	slot->w = w;
+	slot->h = h;
+	slot->type = type;
+	slot->scale = scale;
+	slot->mode = mode;
+	slot->used = ++upload_clock;
+}
+
+static void uploadLock(SDL_Texture* texture, GFX_Renderer* renderer, int type, int scale, int color) {
+	void* pixels;
+	int pitch;
+	if (SDL_LockTexture(texture,NULL,&pixels,&pitch)<0) return;
+	
+	// only called with an effect or scale, the scaler is the only write
+	int w = renderer->true_w;
+	int h = renderer->true_h;
+	scaler_setEffectColor(color);
+	scaler_t scaler = scaler_lookup(FIXED_DEPTH, type, scale, scale);
+	scaler(renderer->src, pixels, w, h, renderer->src_p, w*scale, h*scale, pitch);
+	SDL_UnlockTexture(texture);
+}
+static void uploadUpdate(SDL_Texture* texture, GFX_Renderer* renderer, int type, int scale, int color) {
+	void* pixels;
+	int pitch;
+	GFX_applyEffect(renderer, type, scale, color, &pixels, &pitch);
+	SDL_UpdateTexture(texture,NULL,pixels,pitch);
+}
+
+void GFX_uploadTexture(SDL_Texture* texture, GFX_Renderer* renderer, int type, int scale, int color) {
+	type = GFX_effectType(type, scale);
+	scale = GFX_effectScale(type, scale);
+	if (type==EFFECT_NONE) {
+		SDL_UpdateTexture(texture,NULL,renderer->src,renderer->src_p);
+		return;
+	}
+	
+	if (texture!=upload.texture || type!=upload.type || scale!=upload.scale) {
+		upload.texture = texture;
+		upload.type = type;
+		upload.scale = scale;
+		upload.frames = 0;
+		upload.elapsed[UPLOAD_LOCK] = 0;
+		upload.elapsed[UPLOAD_UPDATE] = 0;
+		
+		struct UploadCache* known = uploadFind(renderer->true_w, renderer->true_h, type, scale);
+		if (known) {
+			upload.mode = known->mode;
+			upload.frames = UPLOAD_SAMPLES*2;
+		}
+	}
+	
+	if (upload.frames>=UPLOAD_SAMPLES*2) {
+		if (upload.mode==UPLOAD_LOCK) uploadLock(texture, renderer, type, scale, color);
+		else uploadUpdate(texture, renderer, type, scale, color);
+		return;
+	}
+	
+	// alternate between the two until both have enough samples
+	int mode = upload.frames++ % 2;
+	uint64_t then = getMicroseconds();
+	if (mode==UPLOAD_LOCK) uploadLock(texture, renderer, type, scale, color);
+	else uploadUpdate(texture, renderer, type, scale, color);
+	upload.elapsed[mode] += getMicroseconds() - then;
+	
+	if (upload.frames==UPLOAD_SAMPLES*2) {
+		upload.mode = upload.elapsed[UPLOAD_LOCK]<=upload.elapsed[UPLOAD_UPDATE] ? UPLOAD_LOCK : UPLOAD_UPDATE;
+		LOG_info("GFX_uploadTexture: %s (lock %ius update %ius)\n",
+			upload.mode==UPLOAD_LOCK ? "lock" : "update",
+			(int)(upload.elapsed[UPLOAD_LOCK] / UPLOAD_SAMPLES),
+			(int)(upload.elapsed[UPLOAD_UPDATE] / UPLOAD_SAMPLES)
+		);
+		uploadRemember(renderer->true_w, renderer->true_h, type, scale, upload.mode);
+	}
+}
+void GFX_freeTextures(void) {
+	for (int i=0; i<TEXTURE_CACHE_SIZE; i++) {
+		struct TextureCache* entry = &texture_cache[i];
+		if (entry->texture) SDL_DestroyTexture(entry->texture);
+	}
+	memset(texture_cache, 0, sizeof(texture_cache));
+	upload.texture = NULL;
+}
+#endif
+
+#ifdef USES_SDL2_VIDEO
+///////////////////////////////
+
+// shared video backend for the sdl2 devices that hand scaling to the
+// gpu, PLAT_initVideo probes the hardware and passes its quirks to
+// GFX_initDevice, the rest of the PLAT_ video functions live here
+
+static struct VID_Context {
+	GFX_Device device;
+	SDL_Window* window;
+	SDL_Renderer* renderer;
+	SDL_Texture* texture;
+	SDL_Texture* target;
+	SDL_Texture* prescaled; // crisp scaled up on the cpu instead of into target
+	SDL_Surface* buffer;
+	SDL_Surface* screen;
+	
+	GFX_Renderer* blit; // yeesh
+	int fx_scale; // integer scale the software effect is baked in at
+	
+	int rotate;
+	int hard_scale;
+	int refresh_rate;
+	int display_width; // eg. a 1080p tv behind a 720p window
+	int display_height;
+	int width;
+	int height;
+	int pitch;
+	int sharpness;
+	SDL_Surface* capture; // see PLAT_captureFlip
+} vid;
+
+// crisp is a nearest neighbor upscale by hard_scale followed by the
+// linear one to the panel, the gpu can do the first with an extra render
+// to texture pass but on weak ones (eg. tg5040) that's slower than
+// scaling straight into the streaming texture on the cpu, so alternate
+// for a few frames after every resize and keep the faster
+
+enum {
+	CRISP_GPU,
+	CRISP_CPU,
+};
+#define CRISP_SAMPLES 16
+static struct Crisp {
+	int frames;
+	int mode;
+	uint64_t elapsed[2];
+	void (*finish)(void); // glFinish when the renderer is gl
+} crisp;
+
+// SDL batches draws and the driver queues them, so a sample has to wait
+// for the gpu to actually finish or the render to texture pass is free
+static void crispFinish(void) {
+#if SDL_VERSION_ATLEAST(2,0,10)
+	SDL_RenderFlush(vid.renderer);
+#endif
+	if (!crisp.finish) crisp.finish = SDL_GL_GetProcAddress("glFinish");
+	if (crisp.finish) crisp.finish();
+}
+
+SDL_Surface* GFX_initDevice(GFX_Device* device) {
+	vid.device = *device;
+	
+	int w = device->width;
+	int h = device->height;
+	int p = device->pitch;
+	
+	SDL_InitSubSystem(SDL_INIT_VIDEO);
+	SDL_ShowCursor(0);
+	
+	// a forced quarter turn needs a portrait window to land in
+	if (device->rotate%2) vid.window = SDL_CreateWindow("", SDL_WINDOWPOS_UNDEFINED, SDL_WINDOWPOS_UNDEFINED, h,w, SDL_WINDOW_SHOWN);
+	else vid.window = SDL_CreateWindow("", SDL_WINDOWPOS_UNDEFINED, SDL_WINDOWPOS_UNDEFINED, w,h, SDL_WINDOW_SHOWN);
+	
+	SDL_DisplayMode mode;
+	SDL_GetCurrentDisplayMode(0, &mode);
+	if (device->rotate) vid.rotate = device->rotate;
+	else if (mode.h>mode.w) vid.rotate = device->portrait_rotate;
+	vid.refresh_rate = mode.refresh_rate;
+	vid.display_width = MAX(mode.w, w);
+	vid.display_height = MAX(mode.h, h);
+	LOG_info("Current display mode: %ix%i@%i (%s) rotate: %i\n", mode.w,mode.h,mode.refresh_rate, SDL_GetPixelFormatName(mode.format), vid.rotate);
+	
+	vid.renderer = SDL_CreateRenderer(vid.window,-1,SDL_RENDERER_ACCELERATED|SDL_RENDERER_PRESENTVSYNC);
+	if (!vid.renderer) vid.renderer = SDL_CreateRenderer(vid.window,-1,SDL_RENDERER_SOFTWARE); // eg. SDL_VIDEODRIVER=offscreen
+	
+	// SDL_RendererInfo info;
+	// SDL_GetRendererInfo(vid.renderer, &info);
+	// LOG_info("Current render driver: %s\n", info.name);
+	
+	vid.texture = GFX_getTexture(vid.renderer, SDL_TEXTUREACCESS_STREAMING, w,h, device->linear);
+	if (device->getAlpha) SDL_SetTextureBlendMode(vid.texture, SDL_BLENDMODE_BLEND);
+	vid.target	= NULL; // only needed for non-native sizes
+	
+	vid.buffer	= SDL_CreateRGBSurfaceFrom(NULL, w,h, FIXED_DEPTH, p, RGBA_MASK_565);
+	vid.screen	= SDL_CreateRGBSurface(SDL_SWSURFACE, w,h, FIXED_DEPTH, RGBA_MASK_565);
+	vid.width	= w;
+	vid.height	= h;
+	vid.pitch	= p;
+	
+	vid.hard_scale = 4;
+	vid.sharpness = SHARPNESS_SOFT;
+	
+	return vid.screen;
+}
+
+static void clearVideo(void) {
+	SDL_FillRect(vid.screen, NULL, 0);
+	for (int i=0; i<3; i++) {
+		SDL_RenderClear(vid.renderer);
+		SDL_RenderPresent(vid.renderer);
+	}
+}
+
+void PLAT_quitVideo(void) {
+	if (vid.device.clear_on_quit) clearVideo();
+
+	SDL_FreeSurface(vid.screen);
+	SDL_FreeSurface(vid.buffer);
+	GFX_freeTextures();
+	SDL_DestroyRenderer(vid.renderer);
+	SDL_DestroyWindow(vid.window);
+
+	SDL_Quit();
+	if (vid.device.clear_on_quit) system("cat /dev/zero > /dev/fb0 2>/dev/null");
+}
+
+void PLAT_clearVideo(SDL_Surface* screen) {
+	SDL_FillRect(screen, NULL, 0); // TODO: revisit
+}
+void PLAT_clearAll(void) {
+	if (vid.device.present_on_clear) {
+		clearVideo();
+		return;
+	}
+	PLAT_clearVideo(vid.screen); // TODO: revist
+	SDL_RenderClear(vid.renderer);
+}
+
+void PLAT_setVsync(int vsync) {
+	
+}
+
+static void resizeVideo(int w, int h, int p) {
+	if (w==vid.width && h==vid.height && p==vid.pitch) return;
+	
+	// TODO: minarch disables crisp (and nn upscale before linear downscale) when native, is this true?
+	
+	if (w>=vid.device.width && h>=vid.device.height) vid.hard_scale = 1;
+	else if (vid.device.hdmi) vid.hard_scale = MIN(MAX(CEIL_DIV(vid.display_width, w), CEIL_DIV(vid.display_height, h)), SCALER_MAX_MUL); // just past the tv so the linear pass only scales down
+	else if (h>=160 && vid.device.tall_hard_scale) vid.hard_scale = vid.device.tall_hard_scale;
+	else vid.hard_scale = 4;
+
+	LOG_info("resizeVideo(%i,%i,%i) hard_scale: %i crisp: %i\n",w,h,p, vid.hard_scale,vid.sharpness==SHARPNESS_CRISP);
+
+	SDL_FreeSurface(vid.buffer);
+	
+	vid.texture = GFX_getTexture(vid.renderer, SDL_TEXTUREACCESS_STREAMING, w,h, vid.sharpness==SHARPNESS_SOFT);
+	if (vid.device.getAlpha) SDL_SetTextureBlendMode(vid.texture, SDL_BLENDMODE_BLEND);
+	
+	if (vid.sharpness==SHARPNESS_CRISP) {
+		vid.target = GFX_getTexture(vid.renderer, SDL_TEXTUREACCESS_TARGET, w * vid.hard_scale,h * vid.hard_scale, 1);
+		vid.prescaled = GFX_getTexture(vid.renderer, SDL_TEXTUREACCESS_STREAMING, w * vid.hard_scale,h * vid.hard_scale, 1);
+		if (vid.device.getAlpha) {
+			SDL_SetTextureBlendMode(vid.target, SDL_BLENDMODE_BLEND);
+			SDL_SetTextureBlendMode(vid.prescaled, SDL_BLENDMODE_BLEND);
+		}
+		crisp.frames = 0;
+		crisp.elapsed[CRISP_GPU] = 0;
+		crisp.elapsed[CRISP_CPU] = 0;
+	}
+	else {
+		vid.target = NULL;
+		vid.prescaled = NULL;
+	}
+	
+	vid.buffer	= SDL_CreateRGBSurfaceFrom(NULL, w,h, FIXED_DEPTH, p, RGBA_MASK_565);
+
+	vid.width	= w;
+	vid.height	= h;
+	vid.pitch	= p;
+}
+
+SDL_Surface* PLAT_resizeVideo(int w, int h, int p) {
+	resizeVideo(w,h,p);
+	return vid.screen;
+}
+
+SDL_Surface* PLAT_setOutput(int hdmi) {
+	if (!vid.device.setOutput) return NULL;
+	
+	uint64_t then = getMicroseconds();
+	GFX_Device device = vid.device;
+	device.setOutput(hdmi, &device);
+	int sharpness = vid.sharpness;
+	
+	// sdl only sees the new output (and its mode) after video restarts,
+	// everything else (audio, input, the core) carries on as is
+	SDL_FreeSurface(vid.screen);
+	SDL_FreeSurface(vid.buffer);
+	GFX_freeTextures();
+	SDL_DestroyRenderer(vid.renderer);
+	SDL_DestroyWindow(vid.window);
+	SDL_QuitSubSystem(SDL_INIT_VIDEO);
+	
+	memset(&vid, 0, sizeof(vid));
+	SDL_Surface* screen = GFX_initDevice(&device);
+	PLAT_setSharpness(sharpness); // init comes up soft, this rebuilds the textures (and target) to match
+	
+	LOG_info("PLAT_setOutput(%i) %ix%i in %ims\n", hdmi, device.width,device.height, (int)((getMicroseconds() - then) / 1000));
+	return screen;
+}
+
+void PLAT_setVideoScaleClip(int x, int y, int width, int height) {
+	// buh
+}
+void PLAT_setNearestNeighbor(int enabled) {
+	// always enabled?
+}
+void PLAT_setSharpness(int sharpness) {
+	if (vid.sharpness==sharpness) return;
+	int p = vid.pitch;
+	vid.pitch = 0;
+	vid.sharpness = sharpness;
+	resizeVideo(vid.width,vid.height,p);
+}
+
+static struct FX_Context {
+	int scale;
+	int type;
+	int color;
+	int next_scale;
+	int next_type;
+	int next_color;
+} effect = {
+	.scale = 1,
+	.next_scale = 1,
+	.type = EFFECT_NONE,
+	.next_type = EFFECT_NONE,
+	.color = 0,
+	.next_color = 0,
+};
+static void updateEffect(void) {
+	effect.scale = effect.next_scale;
+	effect.type = effect.next_type;
+	effect.color = effect.next_color;
+}
+void PLAT_setEffect(int next_type) {
+	effect.next_type = next_type;
+}
+void PLAT_setEffectColor(int next_color) {
+	effect.next_color = next_color;
+}
+void PLAT_vsync(int remaining) {
+	if (remaining>0) SDL_Delay(remaining);
+}
+double PLAT_getRefreshRate(void) {
+	return vid.refresh_rate>0 ? vid.refresh_rate : 60; // 0 when the driver doesn't know
+}
+
+scaler_t PLAT_getScaler(GFX_Renderer* renderer) {
+	// LOG_info("getScaler for scale: %i\n", renderer->scale);
+	effect.next_scale = renderer->scale;
+	return scale1x1_c16;
+}
+
+void PLAT_blitRenderer(GFX_Renderer* renderer) {
+	vid.blit = renderer;
+	SDL_RenderClear(vid.renderer);
+	updateEffect();
+	vid.fx_scale = GFX_effectScale(effect.type, effect.scale);
+	int w = vid.blit->true_w * vid.fx_scale;
+	int h = vid.blit->true_h * vid.fx_scale;
+	resizeVideo(w,h,w*FIXED_BPP);
+}
+
+SDL_Surface* PLAT_captureFlip(void) {
+	// what the panel (or tv) gets, after rotation and scaling
+	int w,h;
+	SDL_GetRendererOutputSize(vid.renderer, &w,&h);
+	vid.capture = SDL_CreateRGBSurface(SDL_SWSURFACE, w,h, FIXED_DEPTH, RGBA_MASK_565);
+	return vid.capture;
+}
+
+static void renderCopy(SDL_Texture* texture, SDL_Rect* src_rect, SDL_Rect* dst_rect, int rotate) {
+	if (!rotate) {
+		SDL_RenderCopy(vid.renderer, texture, src_rect, dst_rect);
+		return;
+	}
+	
+	// rotating around the center of the landscape rect
+	// lands it centered on the portrait panel
+	int oy = (vid.device.width-vid.device.height)/2;
+	int ox = -oy;
+	SDL_Rect rect = dst_rect ? *dst_rect : (SDL_Rect){0,0,vid.device.width,vid.device.height};
+	rect.x += ox;
+	rect.y += oy;
+	SDL_RenderCopyEx(vid.renderer,texture,src_rect,&rect,rotate*90,NULL,SDL_FLIP_NONE);
+}
+
+void PLAT_flip(SDL_Surface* IGNORED, int ignored) {
+	int device_width = vid.device.width;
+	int device_height = vid.device.height;
+	int rotate = vid.device.getRotation ? vid.device.getRotation(vid.rotate) : vid.rotate;
+	int alpha = vid.device.getAlpha ? vid.device.getAlpha() : 255;
+	
+	if (!vid.blit) {
+		resizeVideo(device_width,device_height,vid.device.pitch); // !!!???
+		SDL_UpdateTexture(vid.texture,NULL,vid.screen->pixels,vid.screen->pitch);
+		if (vid.device.getAlpha) SDL_SetTextureAlphaMod(vid.texture, alpha);
+		renderCopy(vid.texture, NULL,NULL, rotate);
+		SDL_RenderPresent(vid.renderer);
+		return;
+	}
+	
+	// effects are already baked in at their own scale so leave those to the gpu
+	int mode = CRISP_GPU;
+	uint64_t then = 0;
+	if (vid.sharpness==SHARPNESS_CRISP && GFX_effectType(effect.type, effect.scale)==EFFECT_NONE && vid.hard_scale>1) {
+		if (crisp.frames<CRISP_SAMPLES*2) {
+			mode = crisp.frames++ % 2;
+			then = getMicroseconds();
+		}
+		else mode = crisp.mode;
+	}
+	
+	SDL_Texture* target = vid.texture;
+	int x = vid.blit->src_x * vid.fx_scale;
+	int y = vid.blit->src_y * vid.fx_scale;
+	int w = vid.blit->src_w * vid.fx_scale;
+	int h = vid.blit->src_h * vid.fx_scale;
+	if (vid.sharpness==SHARPNESS_CRISP && mode==CRISP_CPU) {
+		uploadLock(vid.prescaled, vid.blit, EFFECT_NONE, vid.hard_scale, 0);
+		target = vid.prescaled;
+	}
+	else {
+		// uint32_t then = SDL_GetTicks();
+		GFX_uploadTexture(vid.texture, vid.blit, effect.type, effect.scale, effect.color);
+		// LOG_info("blit blocked for %ims (%i,%i)\n", SDL_GetTicks()-then,vid.buffer->w,vid.buffer->h);
+		
+		if (vid.sharpness==SHARPNESS_CRISP) {
+			SDL_SetRenderTarget(vid.renderer,vid.target);
+			if (vid.device.getAlpha) SDL_SetTextureAlphaMod(vid.texture, 255);
+			SDL_RenderCopy(vid.renderer, vid.texture, NULL,NULL);
+			SDL_SetRenderTarget(vid.renderer,NULL);
+			target = vid.target;
+		}
+	}
+	if (vid.sharpness==SHARPNESS_CRISP) {
+		x *= vid.hard_scale;
+		y *= vid.hard_scale;
+		w *= vid.hard_scale;
+		h *= vid.hard_scale;
+	}
+	
+	SDL_Rect* src_rect = &(SDL_Rect){x,y,w,h};
+	SDL_Rect* dst_rect = &(SDL_Rect){0,0,device_width,device_height};
+	if (vid.blit->aspect==0) { // native or cropped
+		int w = vid.blit->src_w * vid.blit->scale;
+		int h = vid.blit->src_h * vid.blit->scale;
+		int x = (device_width - w) / 2;
+		int y = (device_height - h) / 2;
+		dst_rect->x = x;
+		dst_rect->y = y;
+		dst_rect->w = w;
+		dst_rect->h = h;
+	}
+	else if (vid.blit->aspect>0) { // aspect
+		int h = device_height;
+		int w = h * vid.blit->aspect;
+		if (w>device_width) {
+			double ratio = 1 / vid.blit->aspect;
+			w = device_width;
+			h = w * ratio;
+		}
+		int x = (device_width - w) / 2;
+		int y = (device_height - h) / 2;
+		dst_rect->x = x;
+		dst_rect->y = y;
+		dst_rect->w = w;
+		dst_rect->h = h;
+	}
+	
+	if (vid.device.getAlpha) SDL_SetTextureAlphaMod(target, alpha);
+	renderCopy(target, src_rect, dst_rect, rotate);
+	
+	// stop once the gpu is done but before present, with vsync that
+	// blocks until the next vblank and would drown out the difference
+	uint64_t elapsed = 0;
+	if (then) {
+		crispFinish();
+		elapsed = getMicroseconds() - then;
+	}
+	
+	if (vid.capture) {
+		SDL_RenderReadPixels(vid.renderer, NULL, SDL_PIXELFORMAT_RGB565, vid.capture->pixels, vid.capture->pitch);
+		vid.capture = NULL;
+	}
+	
+	// uint32_t then = SDL_GetTicks();
+	SDL_RenderPresent(vid.renderer);
+	// LOG_info("SDL_RenderPresent blocked for %ims\n", SDL_GetTicks()-then);
+	vid.blit = NULL;
+	
+	if (then) {
+		crisp.elapsed[mode] += elapsed;
+		if (crisp.frames==CRISP_SAMPLES*2) {
+			// a tie goes to the gpu, it leaves the cpu to the core
+			crisp.mode = crisp.elapsed[CRISP_CPU]<crisp.elapsed[CRISP_GPU] ? CRISP_CPU : CRISP_GPU;
+			LOG_info("PLAT_flip: crisp on the %s (gpu %ius cpu %ius)\n",
+				crisp.mode==CRISP_CPU ? "cpu" : "gpu",
+				(int)(crisp.elapsed[CRISP_GPU] / CRISP_SAMPLES),
+				(int)(crisp.elapsed[CRISP_CPU] / CRISP_SAMPLES)
+			);
+		}
+	}
+}
+#endif
+
+///////////////////////////////
+
 void GFX_blitAsset(int asset, SDL_Rect* src_rect, SDL_Surface* dst, SDL_Rect* dst_rect) {
 	SDL_Rect* rect = &asset_rects[asset];
 	SDL_Rect adj_rect = {
@@ -1344,6 +2404,51 @@ FALLBACK_IMPLEMENTATION void PLAT_pollInput(void) {
 	
 	if (lid.has_lid && PLAT_lidChanged(NULL)) pad.just_released |= BTN_SLEEP;
 }
+
+// SDL doesn't expose the fds it reads input from so the fallback opens
+// its own read-only handles on the same event nodes, every open handle
+// gets its own copy of each event so draining these steals nothing
+#define WAIT_FDS 8
+#define WAIT_SLICE 16 // only when none of the nodes could be opened
+static struct WaitInputs {
+	int fds[WAIT_FDS];
+	int count;
+	int opened;
+} wait_inputs;
+
+static void waitOpenInputs(void) {
+	wait_inputs.opened = 1;
+	char path[32];
+	for (int i=0; i<WAIT_FDS; i++) {
+		sprintf(path, "/dev/input/event%i", i);
+		int fd = open(path, O_RDONLY | O_NONBLOCK | O_CLOEXEC);
+		if (fd!=-1) wait_inputs.fds[wait_inputs.count++] = fd;
+	}
+	LOG_info("PLAT_waitInput: polling %i event nodes\n", wait_inputs.count);
+}
+static void waitDrainInputs(void) {
+	char buffer[256];
+	for (int i=0; i<wait_inputs.count; i++) {
+		while (read(wait_inputs.fds[i], buffer, sizeof(buffer))>0);
+	}
+}
+FALLBACK_IMPLEMENTATION void PLAT_waitInput(int timeout) {
+	if (!wait_inputs.opened) waitOpenInputs();
+	
+	uint32_t until = SDL_GetTicks() + timeout;
+	while (!SDL_PollEvent(NULL)) { // pumps but leaves the events for PLAT_pollInput()
+		uint32_t now = SDL_GetTicks();
+		if (now>=until) return;
+		if (!wait_inputs.count) { // nap a frame at a time between checks
+			if (PAD_waitFor(NULL, 0, MIN(until-now, WAIT_SLICE))) return;
+			continue;
+		}
+		if (PAD_waitFor(wait_inputs.fds, wait_inputs.count, until-now)) {
+			waitDrainInputs(); // or the next wait returns straight away
+			return;
+		}
+	}
+}
 FALLBACK_IMPLEMENTATION int PLAT_shouldWake(void) {
 	int lid_open = 1; // assume open by default
 	if (lid.has_lid && PLAT_lidChanged(&lid_open) && lid_open) return 1;
@@ -1394,6 +2499,36 @@ int PAD_tappedMenu(uint32_t now) {
 	return (!ignore_menu && PAD_justReleased(BTN_MENU) && now-menu_start<MENU_DELAY);
 }
 
+// an eventfd other threads bump to end a PAD_wait(), eg. when they
+// have something new to draw
+static int wake_fd = -1;
+static pthread_once_t wake_once = PTHREAD_ONCE_INIT;
+static void PAD_initWake(void) {
+	wake_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+}
+void PAD_interrupt(void) {
+	pthread_once(&wake_once, PAD_initWake);
+	uint64_t one = 1;
+	if (wake_fd!=-1) write(wake_fd, &one, sizeof(one));
+}
+int PAD_waitFor(int* fds, int count, int timeout) {
+	pthread_once(&wake_once, PAD_initWake);
+	
+	struct pollfd pfds[WAIT_FDS+1];
+	int n = 0;
+	for (int i=0; i<count && n<WAIT_FDS; i++) {
+		pfds[n++] = (struct pollfd){ .fd=fds[i], .events=POLLIN };
+	}
+	pfds[n++] = (struct pollfd){ .fd=wake_fd, .events=POLLIN };
+	
+	int ready = poll(pfds, n, timeout);
+	if (ready>0 && (pfds[n-1].revents & POLLIN)) {
+		uint64_t wakes;
+		read(wake_fd, &wakes, sizeof(wakes)); // reset it
+	}
+	return ready>0;
+}
+
 ///////////////////////////////
 
 static struct VIB_Context {
@@ -21,7 +21,9 @@ void LOG_note(int level, const char* fmt, ...);
 
 ///////////////////////////////
 
+#ifndef PAGE_COUNT
 #define PAGE_COUNT	2
+#endif
 #ifndef PAGE_SCALE
 #define PAGE_SCALE	3
 #endif
@@ -108,12 +110,7 @@ enum {
 	SHARPNESS_SOFT,
 };
 
-enum {
-	EFFECT_NONE,
-	EFFECT_LINE,
-	EFFECT_GRID,
-	EFFECT_COUNT,
-};
+// EFFECT_* are in scaler.h
 
 typedef struct GFX_Renderer {
 	void* src;
@@ -154,6 +151,7 @@ SDL_Surface* GFX_init(int mode);
 #define GFX_setEffect PLAT_setEffect // (int effect)
 void GFX_setMode(int mode);
 int GFX_hdmiChanged(void);
+SDL_Surface* GFX_setOutput(int hdmi); // switches between the panel and hdmi in place, NULL when the platform has to restart instead
 
 #define GFX_clear PLAT_clearVideo // (SDL_Surface* screen)
 #define GFX_clearAll PLAT_clearAll // (void)
@@ -161,7 +159,10 @@ int GFX_hdmiChanged(void);
 void GFX_startFrame(void);
 void GFX_flip(SDL_Surface* screen);
 #define GFX_supportsOverscan PLAT_supportsOverscan // (void)
-void GFX_sync(void); // call this to maintain 60fps when not calling GFX_flip() this frame
+void GFX_sync(void); // call this to maintain the target fps when not calling GFX_flip() this frame
+void GFX_setTargetFPS(double fps); // 0 for the panel refresh rate (the default), negative to not wait on the clock (eg. fast forward)
+double GFX_getFrameError(void); // smoothed frame time error in ms
+double GFX_getLatency(void); // smoothed ms from GFX_startFrame to that frame's present returning
 void GFX_quit(void);
 
 enum {
@@ -174,14 +175,51 @@ int GFX_getVsync(void);
 void GFX_setVsync(int vsync);
 
 int GFX_truncateText(TTF_Font* font, const char* in_name, char* out_name, int max_width, int padding); // returns final width
+SDL_Surface* GFX_getText(TTF_Font* font, char* str, int max_width, int padding, SDL_Color color, int* text_width); // truncated like GFX_truncateText, owned by a cache so don't free it
 int GFX_wrapText(TTF_Font* font, char* str, int max_width, int max_lines);
 
 #define GFX_getScaler PLAT_getScaler		// scaler_t:(GFX_Renderer* renderer)
 #define GFX_blitRenderer PLAT_blitRenderer	// void:(GFX_Renderer* renderer)
+#define GFX_captureFlip PLAT_captureFlip	// SDL_Surface*:(void)
 
 scaler_t GFX_getAAScaler(GFX_Renderer* renderer);
 void GFX_freeAAScaler(void);
 
+int GFX_effectType(int type, int scale); // the effect that will actually be baked in at scale, EFFECT_NONE when it doesn't fit
+int GFX_effectScale(int type, int scale); // the integer scale an effect will be baked in at, 1 for none
+int GFX_applyEffect(GFX_Renderer* renderer, int type, int scale, int color, void** pixels, int* pitch); // returns the scale baked into pixels, pixels is just renderer->src when there's no effect
+void GFX_freeEffect(void);
+
+int GFX_initPages(int count, void (*show)(int page), int (*wait)(void)); // called by PLAT_initVideo on page flipped framebuffers, returns the page to draw into
+int GFX_flipPage(int sync); // shows the page drawn into on the next vblank, returns the next page to draw into
+void GFX_waitVblank(void);
+void GFX_quitPages(void);
+int GFX_getMissedFrames(void); // frames that weren't ready for their vblank, 0 without GFX_initPages
+
+#ifdef USE_SDL2
+SDL_Texture* GFX_getTexture(SDL_Renderer* renderer, int access, int w, int h, int linear); // RGB565, cached by size so resolution switches don't reallocate
+void GFX_freeTextures(void);
+void GFX_uploadTexture(SDL_Texture* texture, GFX_Renderer* renderer, int type, int scale, int color); // texture must be true_w,true_h times GFX_effectScale
+#ifdef USES_SDL2_VIDEO
+typedef struct GFX_Device {
+	int width; // window and ui size, eg. HDMI_WIDTH when booted on hdmi
+	int height;
+	int pitch;
+	int linear; // filter the ui texture, helps when it's upscaled over hdmi
+	int portrait_rotate; // quarter turns applied when the panel reports a portrait mode
+	int rotate; // forced quarter turns, for emulating a portrait panel on a desktop
+	int tall_hard_scale; // crisp prescale for sources 160 and taller, 0 to always use 4
+	int clear_on_quit; // blank the screen and /dev/fb0 on quit
+	int present_on_clear; // GFX_clearAll presents a few black frames
+	int (*getRotation)(int rotate); // optional, called every flip with the detected rotation
+	int (*getAlpha)(void); // optional, called every flip, blends output with black below 255
+	int hdmi; // crisp prescales just past the tv's size instead of a fixed hard_scale
+	void (*setOutput)(int hdmi, struct GFX_Device* device); // optional, sizes device for the panel or hdmi so GFX_setOutput can switch without a restart
+} GFX_Device;
+SDL_Surface* GFX_initDevice(GFX_Device* device); // called by PLAT_initVideo, provides the rest of the PLAT_ video functions
+#endif
+#endif
+
 // NOTE: all dimensions should be pre-scaled
 void GFX_blitAsset(int asset, SDL_Rect* src_rect, SDL_Surface* dst, SDL_Rect* dst_rect);
 void GFX_blitPill(int asset, SDL_Surface* dst, SDL_Rect* dst_rect);
@@ -244,6 +282,7 @@ extern PAD_Context pad;
 #define PAD_quit PLAT_quitInput
 #define PAD_poll PLAT_pollInput
 #define PAD_wake PLAT_shouldWake
+#define PAD_wait PLAT_waitInput // blocks until there might be input, PAD_interrupt() is called or timeout (ms) passes
 
 void PAD_setAnalog(int neg, int pos, int value, int repeat_at); // internal
 
@@ -259,6 +298,9 @@ int PAD_justRepeated(int btn);
 
 int PAD_tappedMenu(uint32_t now); // special case, returns 1 on release of BTN_MENU within 250ms if BTN_PLUS/BTN_MINUS haven't been pressed
 
+void PAD_interrupt(void); // safe from any thread, ends a PAD_wait() early (or the next one)
+int PAD_waitFor(int* fds, int count, int timeout); // internal, for PLAT_waitInput(), negative fds are skipped
+
 ///////////////////////////////
 
 void VIB_init(void);
@@ -308,6 +350,7 @@ void PLAT_initInput(void);
 void PLAT_quitInput(void);
 void PLAT_pollInput(void);
 int PLAT_shouldWake(void);
+void PLAT_waitInput(int timeout);
 
 SDL_Surface* PLAT_initVideo(void);
 void PLAT_quitVideo(void);
@@ -324,7 +367,10 @@ void PLAT_vsync(int remaining);
 scaler_t PLAT_getScaler(GFX_Renderer* renderer);
 void PLAT_blitRenderer(GFX_Renderer* renderer);
 void PLAT_flip(SDL_Surface* screen, int sync);
+SDL_Surface* PLAT_captureFlip(void); // the next flip is also read back into the returned surface (caller frees), shared sdl2 backend only
 int PLAT_supportsOverscan(void);
+double PLAT_getRefreshRate(void);
+SDL_Surface* PLAT_setOutput(int hdmi);
 
 SDL_Surface* PLAT_initOverlay(void);
 void PLAT_quitOverlay(void);
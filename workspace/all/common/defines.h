@@ -21,9 +21,13 @@
 #define RECENT_PATH SHARED_USERDATA_PATH "/.minui/recent.txt"
 #define SIMPLE_MODE_PATH SHARED_USERDATA_PATH "/enable-simple-mode"
 #define AUTO_RESUME_PATH SHARED_USERDATA_PATH "/.minui/auto_resume.txt"
+#define TRACE_FLAG_PATH SHARED_USERDATA_PATH "/enable-startup-trace"
+#define TRACE_PATH USERDATA_PATH "/.minui/startup.txt" // per platform, one tab separated line per launch phase
+#define INDEX_PATH USERDATA_PATH "/.minui/index.bin" // per platform, which systems show depends on its paks
 #define AUTO_RESUME_SLOT 9
 
 #define FAUX_RECENT_PATH SDCARD_PATH "/Recently Played"
+#define FAUX_SEARCH_PATH SDCARD_PATH "/Search"
 #define COLLECTIONS_PATH SDCARD_PATH "/Collections"
 
 #define LAST_PATH "/tmp/last.txt" // transient
@@ -3,6 +3,7 @@
 #include <string.h>
 
 #include "platform.h" // for HAS_NEON
+#include "scaler.h"
 
 //
 //	arm NEON / C integer scalers for ARMv7 devices
@@ -21,8 +22,6 @@
 //	if odd#, then handled by the C scaler
 //
 
-static void dummy(void* __restrict src, void* __restrict dst, uint32_t sw, uint32_t sh, uint32_t sp, uint32_t dw, uint32_t dh, uint32_t dp) {}
-
 // 
 // C scalers for Trimui Model S and GKD Pixel
 //
@@ -74,352 +73,268 @@ void scale2x_c16to32(void* __restrict src, void* __restrict dst, uint32_t sw, ui
 
 //
 //	C scalers
+//	every xmul (1-8) x ymul (1-8) x bpp (16/32) x effect combination
+//	is generated from scale_c() below, use scaler_lookup() to pick one
 //
-void scale1x_c16(void* __restrict src, void* __restrict dst, uint32_t sw, uint32_t sh, uint32_t sp, uint32_t dw, uint32_t dh, uint32_t dp, uint32_t ymul) {
-	if (!sw||!sh||!ymul) return;
-	uint32_t swl = sw*sizeof(uint16_t);
-	if (!sp) { sp = swl; } if (!dp) { dp = swl*1; }
-	if ((ymul == 1)&&(swl == sp)&&(sp == dp)) memcpy(dst, src, sp*sh);
-	else {
-		if (swl>dp) swl = dp;
-		for (; sh>0; sh--, src=(uint8_t*)src+sp) {
-			for (uint32_t i=ymul; i>0; i--, dst=(uint8_t*)dst+dp) memcpy(dst, src, swl);
-		}
-	}
-}
 
-void scale1x1_c16(void* __restrict src, void* __restrict dst, uint32_t sw, uint32_t sh, uint32_t sp, uint32_t dw, uint32_t dh, uint32_t dp) {
-	scale1x_c16(src, dst, sw, sh, sp, dw, dh, dp, 1); }
-void scale1x2_c16(void* __restrict src, void* __restrict dst, uint32_t sw, uint32_t sh, uint32_t sp, uint32_t dw, uint32_t dh, uint32_t dp) {
-	scale1x_c16(src, dst, sw, sh, sp, dw, dh, dp, 2); }
-void scale1x3_c16(void* __restrict src, void* __restrict dst, uint32_t sw, uint32_t sh, uint32_t sp, uint32_t dw, uint32_t dh, uint32_t dp) {
-	scale1x_c16(src, dst, sw, sh, sp, dw, dh, dp, 3); }
-void scale1x4_c16(void* __restrict src, void* __restrict dst, uint32_t sw, uint32_t sh, uint32_t sp, uint32_t dw, uint32_t dh, uint32_t dp) {
-	scale1x_c16(src, dst, sw, sh, sp, dw, dh, dp, 4); }
+// from gambatte-dms
+//from RGB565
+#define cR(A) (((A) & 0xf800) >> 11)
+#define cG(A) (((A) & 0x7e0) >> 5)
+#define cB(A) ((A) & 0x1f)
+//to RGB565
+#define Weight2_3(A, B)  (((((cR(A) << 1) + (cR(B) * 3)) / 5) & 0x1f) << 11 | ((((cG(A) << 1) + (cG(B) * 3)) / 5) & 0x3f) << 5 | ((((cB(A) << 1) + (cB(B) * 3)) / 5) & 0x1f))
+#define Weight3_1(A, B)  ((((cR(B) + (cR(A) * 3)) >> 2) & 0x1f) << 11 | (((cG(B) + (cG(A) * 3)) >> 2) & 0x3f) << 5 | (((cB(B) + (cB(A) * 3)) >> 2) & 0x1f))
+#define Weight3_2(A, B)  (((((cR(B) << 1) + (cR(A) * 3)) / 5) & 0x1f) << 11 | ((((cG(B) << 1) + (cG(A) * 3)) / 5) & 0x3f) << 5 | ((((cB(B) << 1) + (cB(A) * 3)) / 5) & 0x1f))
 
-void scale1x_c32(void* __restrict src, void* __restrict dst, uint32_t sw, uint32_t sh, uint32_t sp, uint32_t dw, uint32_t dh, uint32_t dp, uint32_t ymul) {
-	if (!sw||!sh||!ymul) return;
-	uint32_t swl = sw*sizeof(uint32_t);
-	if (!sp) { sp = swl; } if (!dp) { dp = swl*1; }
-	if ((ymul == 1)&&(swl == sp)&&(sp == dp)) memcpy(dst, src, sp*sh);
-	else {
-		for (; sh>0; sh--, src=(uint8_t*)src+sp) {
-			for (uint32_t i=ymul; i>0; i--, dst=(uint8_t*)dst+dp) memcpy(dst, src, swl);
-		}
+// same weights per 8-bit channel, alpha is left alone
+#define c8(A,S) (((A) >> (S)) & 0xff)
+#define Weight32(A, B, WA, WB, D)  (((A) & 0xff000000) | \
+	(((c8(A,16) * (WA) + c8(B,16) * (WB)) / (D)) << 16) | \
+	(((c8(A, 8) * (WA) + c8(B, 8) * (WB)) / (D)) <<  8) | \
+	(((c8(A, 0) * (WA) + c8(B, 0) * (WB)) / (D))      ))
+
+enum {
+	DIM_NONE,	// 100%
+	DIM_LIGHT,	//  75%
+	DIM_MEDIUM,	//  60%
+	DIM_HEAVY,	//  40%
+	DIM_COUNT,
+};
+
+// levels blend toward k, black unless the grid is tinted
+static inline uint16_t dim16(uint16_t c, int level, uint16_t k) {
+	switch (level) {
+		case DIM_LIGHT:  return Weight3_1(c, k);
+		case DIM_MEDIUM: return Weight3_2(c, k);
+		case DIM_HEAVY:  return Weight2_3(c, k);
 	}
+	return c;
 }
-
-void scale1x1_c32(void* __restrict src, void* __restrict dst, uint32_t sw, uint32_t sh, uint32_t sp, uint32_t dw, uint32_t dh, uint32_t dp) {
-	scale1x_c32(src, dst, sw, sh, sp, dw, dh, dp, 1); }
-void scale1x2_c32(void* __restrict src, void* __restrict dst, uint32_t sw, uint32_t sh, uint32_t sp, uint32_t dw, uint32_t dh, uint32_t dp) {
-	scale1x_c32(src, dst, sw, sh, sp, dw, dh, dp, 2); }
-void scale1x3_c32(void* __restrict src, void* __restrict dst, uint32_t sw, uint32_t sh, uint32_t sp, uint32_t dw, uint32_t dh, uint32_t dp) {
-	scale1x_c32(src, dst, sw, sh, sp, dw, dh, dp, 3); }
-void scale1x4_c32(void* __restrict src, void* __restrict dst, uint32_t sw, uint32_t sh, uint32_t sp, uint32_t dw, uint32_t dh, uint32_t dp) {
-	scale1x_c32(src, dst, sw, sh, sp, dw, dh, dp, 4); }
-
-void scale2x_c16(void* __restrict src, void* __restrict dst, uint32_t sw, uint32_t sh, uint32_t sp, uint32_t dw, uint32_t dh, uint32_t dp, uint32_t ymul) {
-	if (!sw||!sh||!ymul) return;
-	uint32_t x, dx, pix, dpix1, dpix2, swl = sw*sizeof(uint16_t);
-	if (!sp) { sp = swl; } swl*=2; if (!dp) { dp = swl; }
-	for (; sh>0; sh--, src=(uint8_t*)src+sp) {
-		uint32_t *s = (uint32_t* __restrict)src;
-		uint32_t *d = (uint32_t* __restrict)dst;
-		for (x=dx=0; x<(sw/2); x++, dx+=2) {
-			pix = s[x];
-			dpix1=(pix & 0x0000FFFF)|(pix<<16);
-			dpix2=(pix & 0xFFFF0000)|(pix>>16);
-			d[dx] = dpix1; d[dx+1] = dpix2;
-		}
-		if (sw&1) {
-			uint16_t *s16 = (uint16_t*)s;
-			uint16_t pix16 = s16[x*2];
-			d[dx] = pix16|(pix16<<16);
-		}
-		void* __restrict dstsrc = dst; dst = (uint8_t*)dst+dp;
-		for (uint32_t i=ymul-1; i>0; i--, dst=(uint8_t*)dst+dp) memcpy(dst, dstsrc, swl);
+static inline uint32_t dim32(uint32_t c, int level, uint32_t k) {
+	switch (level) {
+		case DIM_LIGHT:  return Weight32(c, k, 3, 1, 4);
+		case DIM_MEDIUM: return Weight32(c, k, 3, 2, 5);
+		case DIM_HEAVY:  return Weight32(c, k, 2, 3, 5);
 	}
+	return c;
 }
 
-void scale2x1_c16(void* __restrict src, void* __restrict dst, uint32_t sw, uint32_t sh, uint32_t sp, uint32_t dw, uint32_t dh, uint32_t dp) {
-	scale2x_c16(src, dst, sw, sh, sp, dw, dh, dp, 1); }
-void scale2x2_c16(void* __restrict src, void* __restrict dst, uint32_t sw, uint32_t sh, uint32_t sp, uint32_t dw, uint32_t dh, uint32_t dp) {
-	scale2x_c16(src, dst, sw, sh, sp, dw, dh, dp, 2); }
-void scale2x3_c16(void* __restrict src, void* __restrict dst, uint32_t sw, uint32_t sh, uint32_t sp, uint32_t dw, uint32_t dh, uint32_t dp) {
-	scale2x_c16(src, dst, sw, sh, sp, dw, dh, dp, 3); }
-void scale2x4_c16(void* __restrict src, void* __restrict dst, uint32_t sw, uint32_t sh, uint32_t sp, uint32_t dw, uint32_t dh, uint32_t dp) {
-	scale2x_c16(src, dst, sw, sh, sp, dw, dh, dp, 4); }
-
-void scale2x_c32(void* __restrict src, void* __restrict dst, uint32_t sw, uint32_t sh, uint32_t sp, uint32_t dw, uint32_t dh, uint32_t dp, uint32_t ymul) {
-	if (!sw||!sh||!ymul) return;
-	uint32_t x, dx, pix, swl = sw*sizeof(uint32_t);
-	if (!sp) { sp = swl; } swl*=2; if (!dp) { dp = swl; }
-	for (; sh>0; sh--, src=(uint8_t*)src+sp) {
-		uint32_t *s = (uint32_t* __restrict)src;
-		uint32_t *d = (uint32_t* __restrict)dst;
-		for (x=dx=0; x<sw; x++, dx+=2) {
-			pix = s[x];
-			d[dx] = pix; d[dx+1] = pix;
-		}
-		void* __restrict dstsrc = dst; dst = (uint8_t*)dst+dp;
-		for (uint32_t i=ymul-1; i>0; i--, dst=(uint8_t*)dst+dp) memcpy(dst, dstsrc, swl);
-	}
+// eg. the dmg palette's darkest color
+static uint16_t grid_tint16 = 0x0000;
+static uint32_t grid_tint32 = 0x00000000;
+void scaler_setEffectColor(uint16_t color) {
+	uint32_t r = cR(color), g = cG(color), b = cB(color);
+	grid_tint16 = color;
+	grid_tint32 = ((r<<3)|(r>>2))<<16 | ((g<<2)|(g>>4))<<8 | ((b<<3)|(b>>2));
 }
 
-void scale2x1_c32(void* __restrict src, void* __restrict dst, uint32_t sw, uint32_t sh, uint32_t sp, uint32_t dw, uint32_t dh, uint32_t dp) {
-	scale2x_c32(src, dst, sw, sh, sp, dw, dh, dp, 1); }
-void scale2x2_c32(void* __restrict src, void* __restrict dst, uint32_t sw, uint32_t sh, uint32_t sp, uint32_t dw, uint32_t dh, uint32_t dp) {
-	scale2x_c32(src, dst, sw, sh, sp, dw, dh, dp, 2); }
-void scale2x3_c32(void* __restrict src, void* __restrict dst, uint32_t sw, uint32_t sh, uint32_t sp, uint32_t dw, uint32_t dh, uint32_t dp) {
-	scale2x_c32(src, dst, sw, sh, sp, dw, dh, dp, 3); }
-void scale2x4_c32(void* __restrict src, void* __restrict dst, uint32_t sw, uint32_t sh, uint32_t sp, uint32_t dw, uint32_t dh, uint32_t dp) {
-	scale2x_c32(src, dst, sw, sh, sp, dw, dh, dp, 4); }
-
-void scale3x_c16(void* __restrict src, void* __restrict dst, uint32_t sw, uint32_t sh, uint32_t sp, uint32_t dw, uint32_t dh, uint32_t dp, uint32_t ymul) {
-	if (!sw||!sh||!ymul) return;
-	uint32_t x, dx, pix, dpix1, dpix2, swl = sw*sizeof(uint16_t);
-	if (!sp) { sp = swl; } swl*=3; if (!dp) { dp = swl; }
-	for (; sh>0; sh--, src=(uint8_t*)src+sp) {
-		uint32_t *s = (uint32_t* __restrict)src;
-		uint32_t *d = (uint32_t* __restrict)dst;
-		for (x=dx=0; x<(sw/2); x++, dx+=3) {
-			pix = s[x];
-			dpix1=(pix & 0x0000FFFF)|(pix<<16);
-			dpix2=(pix & 0xFFFF0000)|(pix>>16);
-			d[dx] = dpix1; d[dx+1] = pix; d[dx+2] = dpix2;
+//
+//	dim levels for row y of an xmul*ymul block, lead is the
+//	first column and rest is every other column
+//	line: darken every other row (1x darkens every other src row)
+//	grid: darken the left column and bottom row (2x: top row)
+//
+static inline void effect_levels(int effect, int xmul, uint32_t ymul, uint32_t y, int* lead, int* rest) {
+	*lead = *rest = DIM_NONE;
+	if (effect==EFFECT_LINE) {
+		if (ymul==1) { if (y&1) *lead = *rest = DIM_LIGHT; }
+		else if (ymul&1) { if (!(y&1) && y<ymul-1) *lead = *rest = DIM_MEDIUM; }
+		else if (y&1) *lead = *rest = DIM_MEDIUM;
+	}
+	else if (effect==EFFECT_GRID && xmul>1 && ymul>1) {
+		if (xmul<3 || ymul<3) {
+			*lead = DIM_LIGHT;
+			if (y==0) *rest = DIM_LIGHT;
 		}
-		if (sw&1) {
-			uint16_t *s16 = (uint16_t*)s;
-			uint16_t *d16 = (uint16_t*)d;
-			uint16_t pix16 = s16[x*2];
-			dpix1 = pix16|(pix16<<16);
-			d[dx] = dpix1; d16[(dx+1)*2] = pix16;
+		else if (y<ymul-1) *lead = DIM_MEDIUM;
+		else {
+			*lead = DIM_HEAVY;
+			*rest = DIM_MEDIUM;
 		}
-		void* __restrict dstsrc = dst; dst = (uint8_t*)dst+dp;
-		for (uint32_t i=ymul-1; i>0; i--, dst=(uint8_t*)dst+dp) memcpy(dst, dstsrc, swl);
 	}
 }
 
-void scale3x1_c16(void* __restrict src, void* __restrict dst, uint32_t sw, uint32_t sh, uint32_t sp, uint32_t dw, uint32_t dh, uint32_t dp) {
-	scale3x_c16(src, dst, sw, sh, sp, dw, dh, dp, 1); }
-void scale3x2_c16(void* __restrict src, void* __restrict dst, uint32_t sw, uint32_t sh, uint32_t sp, uint32_t dw, uint32_t dh, uint32_t dp) {
-	scale3x_c16(src, dst, sw, sh, sp, dw, dh, dp, 2); }
-void scale3x3_c16(void* __restrict src, void* __restrict dst, uint32_t sw, uint32_t sh, uint32_t sp, uint32_t dw, uint32_t dh, uint32_t dp) {
-	scale3x_c16(src, dst, sw, sh, sp, dw, dh, dp, 3); }
-void scale3x4_c16(void* __restrict src, void* __restrict dst, uint32_t sw, uint32_t sh, uint32_t sp, uint32_t dw, uint32_t dh, uint32_t dp) {
-	scale3x_c16(src, dst, sw, sh, sp, dw, dh, dp, 4); }
-
-void scale3x_c32(void* __restrict src, void* __restrict dst, uint32_t sw, uint32_t sh, uint32_t sp, uint32_t dw, uint32_t dh, uint32_t dp, uint32_t ymul) {
-	if (!sw||!sh||!ymul) return;
-	uint32_t x, dx, pix, swl = sw*sizeof(uint32_t);
-	if (!sp) { sp = swl; } swl*=3; if (!dp) { dp = swl; }
-	for (; sh>0; sh--, src=(uint8_t*)src+sp) {
-		uint32_t *s = (uint32_t* __restrict)src;
-		uint32_t *d = (uint32_t* __restrict)dst;
-		for (x=dx=0; x<sw; x++, dx+=3) {
-			pix = s[x];
-			d[dx] = pix; d[dx+1] = pix; d[dx+2] = pix;
+// lead is copied into the first column of each block, rest into the others
+static inline __attribute__((always_inline)) void scale_row16(uint16_t* __restrict d, uint16_t* lead, uint16_t* rest, uint32_t sw, const int xmul) {
+	uint32_t x = 0;
+	if (!((uintptr_t)d&3)) { // two src pixels fill xmul words
+		uint32_t* __restrict d32 = (uint32_t*)d;
+		for (; x+1<sw; x+=2, d32+=xmul) {
+			uint32_t a0 = lead[x], a1 = rest[x];
+			uint32_t b0 = lead[x+1], b1 = rest[x+1];
+			for (int i=0; i<xmul; i++) {
+				int lo = i*2, hi = lo+1;
+				uint32_t plo = lo<xmul ? (lo ? a1 : a0) : (lo==xmul ? b0 : b1);
+				uint32_t phi = hi<xmul ? a1 : (hi==xmul ? b0 : b1);
+				d32[i] = plo | (phi<<16);
+			}
 		}
-		void* __restrict dstsrc = dst; dst = (uint8_t*)dst+dp;
-		for (uint32_t i=ymul-1; i>0; i--, dst=(uint8_t*)dst+dp) memcpy(dst, dstsrc, swl);
+		d = (uint16_t*)d32;
 	}
-}
-
-void scale3x1_c32(void* __restrict src, void* __restrict dst, uint32_t sw, uint32_t sh, uint32_t sp, uint32_t dw, uint32_t dh, uint32_t dp) {
-	scale3x_c32(src, dst, sw, sh, sp, dw, dh, dp, 1); }
-void scale3x2_c32(void* __restrict src, void* __restrict dst, uint32_t sw, uint32_t sh, uint32_t sp, uint32_t dw, uint32_t dh, uint32_t dp) {
-	scale3x_c32(src, dst, sw, sh, sp, dw, dh, dp, 2); }
-void scale3x3_c32(void* __restrict src, void* __restrict dst, uint32_t sw, uint32_t sh, uint32_t sp, uint32_t dw, uint32_t dh, uint32_t dp) {
-	scale3x_c32(src, dst, sw, sh, sp, dw, dh, dp, 3); }
-void scale3x4_c32(void* __restrict src, void* __restrict dst, uint32_t sw, uint32_t sh, uint32_t sp, uint32_t dw, uint32_t dh, uint32_t dp) {
-	scale3x_c32(src, dst, sw, sh, sp, dw, dh, dp, 4); }
-
-void scale4x_c16(void* __restrict src, void* __restrict dst, uint32_t sw, uint32_t sh, uint32_t sp, uint32_t dw, uint32_t dh, uint32_t dp, uint32_t ymul) {
-	if (!sw||!sh||!ymul) return;
-	uint32_t x, dx, pix, dpix1, dpix2, swl = sw*sizeof(uint16_t);
-	if (!sp) { sp = swl; } swl*=4; if (!dp) { dp = swl; }
-	for (; sh>0; sh--, src=(uint8_t*)src+sp) {
-		uint32_t *s = (uint32_t* __restrict)src;
-		uint32_t *d = (uint32_t* __restrict)dst;
-		for (x=dx=0; x<(sw/2); x++, dx+=4) {
-			pix = s[x];
-			dpix1=(pix & 0x0000FFFF)|(pix<<16);
-			dpix2=(pix & 0xFFFF0000)|(pix>>16);
-			d[dx] = dpix1; d[dx+1] = dpix1; d[dx+2] = dpix2; d[dx+3] = dpix2;
-		}
-		if (sw&1) {
-			uint16_t *s16 = (uint16_t*)s;
-			uint16_t pix16 = s16[x*2];
-			dpix1 = pix16|(pix16<<16);
-			d[dx] = dpix1; d[dx+1] = dpix1;
-		}
-		void* __restrict dstsrc = dst; dst = (uint8_t*)dst+dp;
-		for (uint32_t i=ymul-1; i>0; i--, dst=(uint8_t*)dst+dp) memcpy(dst, dstsrc, swl);
+	for (; x<sw; x++, d+=xmul) {
+		d[0] = lead[x];
+		for (int i=1; i<xmul; i++) d[i] = rest[x];
 	}
 }
-
-void scale4x1_c16(void* __restrict src, void* __restrict dst, uint32_t sw, uint32_t sh, uint32_t sp, uint32_t dw, uint32_t dh, uint32_t dp) {
-	scale4x_c16(src, dst, sw, sh, sp, dw, dh, dp, 1); }
-void scale4x2_c16(void* __restrict src, void* __restrict dst, uint32_t sw, uint32_t sh, uint32_t sp, uint32_t dw, uint32_t dh, uint32_t dp) {
-	scale4x_c16(src, dst, sw, sh, sp, dw, dh, dp, 2); }
-void scale4x3_c16(void* __restrict src, void* __restrict dst, uint32_t sw, uint32_t sh, uint32_t sp, uint32_t dw, uint32_t dh, uint32_t dp) {
-	scale4x_c16(src, dst, sw, sh, sp, dw, dh, dp, 3); }
-void scale4x4_c16(void* __restrict src, void* __restrict dst, uint32_t sw, uint32_t sh, uint32_t sp, uint32_t dw, uint32_t dh, uint32_t dp) {
-	scale4x_c16(src, dst, sw, sh, sp, dw, dh, dp, 4); }
-
-void scale4x_c32(void* __restrict src, void* __restrict dst, uint32_t sw, uint32_t sh, uint32_t sp, uint32_t dw, uint32_t dh, uint32_t dp, uint32_t ymul) {
-	if (!sw||!sh||!ymul) return;
-	uint32_t x, dx, pix, swl = sw*sizeof(uint32_t);
-	if (!sp) { sp = swl; } swl*=4; if (!dp) { dp = swl; }
-	for (; sh>0; sh--, src=(uint8_t*)src+sp) {
-		uint32_t *s = (uint32_t* __restrict)src;
-		uint32_t *d = (uint32_t* __restrict)dst;
-		for (x=dx=0; x<sw; x++, dx+=4) {
-			pix = s[x];
-			d[dx] = pix; d[dx+1] = pix; d[dx+2] = pix; d[dx+3] = pix;
-		}
-		void* __restrict dstsrc = dst; dst = (uint8_t*)dst+dp;
-		for (uint32_t i=ymul-1; i>0; i--, dst=(uint8_t*)dst+dp) memcpy(dst, dstsrc, swl);
+static inline __attribute__((always_inline)) void scale_row32(uint32_t* __restrict d, uint32_t* lead, uint32_t* rest, uint32_t sw, const int xmul) {
+	for (uint32_t x=0; x<sw; x++, d+=xmul) {
+		d[0] = lead[x];
+		for (int i=1; i<xmul; i++) d[i] = rest[x];
 	}
 }
 
-void scale4x1_c32(void* __restrict src, void* __restrict dst, uint32_t sw, uint32_t sh, uint32_t sp, uint32_t dw, uint32_t dh, uint32_t dp) {
-	scale4x_c32(src, dst, sw, sh, sp, dw, dh, dp, 1); }
-void scale4x2_c32(void* __restrict src, void* __restrict dst, uint32_t sw, uint32_t sh, uint32_t sp, uint32_t dw, uint32_t dh, uint32_t dp) {
-	scale4x_c32(src, dst, sw, sh, sp, dw, dh, dp, 2); }
-void scale4x3_c32(void* __restrict src, void* __restrict dst, uint32_t sw, uint32_t sh, uint32_t sp, uint32_t dw, uint32_t dh, uint32_t dp) {
-	scale4x_c32(src, dst, sw, sh, sp, dw, dh, dp, 3); }
-void scale4x4_c32(void* __restrict src, void* __restrict dst, uint32_t sw, uint32_t sh, uint32_t sp, uint32_t dw, uint32_t dh, uint32_t dp) {
-	scale4x_c32(src, dst, sw, sh, sp, dw, dh, dp, 4); }
-
-void scale5x_c16(void* __restrict src, void* __restrict dst, uint32_t sw, uint32_t sh, uint32_t sp, uint32_t dw, uint32_t dh, uint32_t dp, uint32_t ymul) {
-	if (!sw||!sh||!ymul) return;
-	uint32_t x, dx, pix, dpix1, dpix2, swl = sw*sizeof(uint16_t);
-	if (!sp) { sp = swl; } swl*=5; if (!dp) { dp = swl; }
-	for (; sh>0; sh--, src=(uint8_t*)src+sp) {
-		uint32_t *s = (uint32_t* __restrict)src;
-		uint32_t *d = (uint32_t* __restrict)dst;
-		for (x=dx=0; x<(sw/2); x++, dx+=5) {
-			pix = s[x];
-			dpix1=(pix & 0x0000FFFF)|(pix<<16);
-			dpix2=(pix & 0xFFFF0000)|(pix>>16);
-			d[dx] = dpix1; d[dx+1] = dpix1; d[dx+2] = pix; d[dx+3] = dpix2; d[dx+4] = dpix2;
-		}
-		if (sw&1) {
-			uint16_t *s16 = (uint16_t*)s;
-			uint16_t *d16 = (uint16_t*)d;
-			uint16_t pix16 = s16[x*2];
-			dpix1 = pix16|(pix16<<16);
-			d[dx] = dpix1; d[dx+1] = dpix1; d16[(dx+2)*2] = pix16;
-		}
-		void* __restrict dstsrc = dst; dst = (uint8_t*)dst+dp;
-		for (uint32_t i=ymul-1; i>0; i--, dst=(uint8_t*)dst+dp) memcpy(dst, dstsrc, swl);
+static void dim_pixels(void* __restrict dst, void* src, uint32_t count, int bpp, int level, uint32_t k) {
+	// level is hoisted out of the loops so they can vectorize
+	#define DIM_PIXELS(l) \
+		if (bpp==2) { uint16_t* s = src; uint16_t* d = dst; for (uint32_t x=0; x<count; x++) d[x] = dim16(s[x], l, k); } \
+		else { uint32_t* s = src; uint32_t* d = dst; for (uint32_t x=0; x<count; x++) d[x] = dim32(s[x], l, k); }
+	switch (level) {
+		case DIM_LIGHT:  DIM_PIXELS(DIM_LIGHT); break;
+		case DIM_MEDIUM: DIM_PIXELS(DIM_MEDIUM); break;
+		case DIM_HEAVY:  DIM_PIXELS(DIM_HEAVY); break;
 	}
+	#undef DIM_PIXELS
 }
 
-void scale5x1_c16(void* __restrict src, void* __restrict dst, uint32_t sw, uint32_t sh, uint32_t sp, uint32_t dw, uint32_t dh, uint32_t dp) {
-	scale5x_c16(src, dst, sw, sh, sp, dw, dh, dp, 1); }
-void scale5x2_c16(void* __restrict src, void* __restrict dst, uint32_t sw, uint32_t sh, uint32_t sp, uint32_t dw, uint32_t dh, uint32_t dp) {
-	scale5x_c16(src, dst, sw, sh, sp, dw, dh, dp, 2); }
-void scale5x3_c16(void* __restrict src, void* __restrict dst, uint32_t sw, uint32_t sh, uint32_t sp, uint32_t dw, uint32_t dh, uint32_t dp) {
-	scale5x_c16(src, dst, sw, sh, sp, dw, dh, dp, 3); }
-void scale5x4_c16(void* __restrict src, void* __restrict dst, uint32_t sw, uint32_t sh, uint32_t sp, uint32_t dw, uint32_t dh, uint32_t dp) {
-	scale5x_c16(src, dst, sw, sh, sp, dw, dh, dp, 4); }
-void scale5x5_c16(void* __restrict src, void* __restrict dst, uint32_t sw, uint32_t sh, uint32_t sp, uint32_t dw, uint32_t dh, uint32_t dp) {
-	scale5x_c16(src, dst, sw, sh, sp, dw, dh, dp, 5); }
-
-void scale5x_c32(void* __restrict src, void* __restrict dst, uint32_t sw, uint32_t sh, uint32_t sp, uint32_t dw, uint32_t dh, uint32_t dp, uint32_t ymul) {
-	if (!sw||!sh||!ymul) return;
-	uint32_t x, dx, pix, swl = sw*sizeof(uint32_t);
-	if (!sp) { sp = swl; } swl*=5; if (!dp) { dp = swl; }
-	for (; sh>0; sh--, src=(uint8_t*)src+sp) {
-		uint32_t *s = (uint32_t* __restrict)src;
-		uint32_t *d = (uint32_t* __restrict)dst;
-		for (x=dx=0; x<sw; x++, dx+=5) {
-			pix = s[x];
-			d[dx] = pix; d[dx+1] = pix; d[dx+2] = pix; d[dx+3] = pix; d[dx+4] = pix;
-		}
-		void* __restrict dstsrc = dst; dst = (uint8_t*)dst+dp;
-		for (uint32_t i=ymul-1; i>0; i--, dst=(uint8_t*)dst+dp) memcpy(dst, dstsrc, swl);
-	}
+// dimmed copy of the current src row into its slot in scratch, one
+// slot per level below DIM_NONE (which is just the src row)
+static void* dim_line(void* scratch, void* src, uint32_t sw, int bpp, int level, uint32_t k) {
+	void* line = (uint8_t*)scratch + (level-1)*sw*bpp;
+	dim_pixels(line, src, sw, bpp, level, k);
+	return line;
 }
 
-void scale5x1_c32(void* __restrict src, void* __restrict dst, uint32_t sw, uint32_t sh, uint32_t sp, uint32_t dw, uint32_t dh, uint32_t dp) {
-	scale5x_c32(src, dst, sw, sh, sp, dw, dh, dp, 1); }
-void scale5x2_c32(void* __restrict src, void* __restrict dst, uint32_t sw, uint32_t sh, uint32_t sp, uint32_t dw, uint32_t dh, uint32_t dp) {
-	scale5x_c32(src, dst, sw, sh, sp, dw, dh, dp, 2); }
-void scale5x3_c32(void* __restrict src, void* __restrict dst, uint32_t sw, uint32_t sh, uint32_t sp, uint32_t dw, uint32_t dh, uint32_t dp) {
-	scale5x_c32(src, dst, sw, sh, sp, dw, dh, dp, 3); }
-void scale5x4_c32(void* __restrict src, void* __restrict dst, uint32_t sw, uint32_t sh, uint32_t sp, uint32_t dw, uint32_t dh, uint32_t dp) {
-	scale5x_c32(src, dst, sw, sh, sp, dw, dh, dp, 4); }
-void scale5x5_c32(void* __restrict src, void* __restrict dst, uint32_t sw, uint32_t sh, uint32_t sp, uint32_t dw, uint32_t dh, uint32_t dp) {
-	scale5x_c32(src, dst, sw, sh, sp, dw, dh, dp, 5); }
-
-void scale6x_c16(void* __restrict src, void* __restrict dst, uint32_t sw, uint32_t sh, uint32_t sp, uint32_t dw, uint32_t dh, uint32_t dp, uint32_t ymul) {
+static inline __attribute__((always_inline)) void scale_c(void* __restrict src, void* __restrict dst, uint32_t sw, uint32_t sh, uint32_t sp, uint32_t dp, uint32_t ymul, const int bpp, const int xmul, const int effect) {
 	if (!sw||!sh||!ymul) return;
-	uint32_t x, dx, pix, dpix1, dpix2, swl = sw*sizeof(uint16_t);
-	if (!sp) { sp = swl; } swl*=6; if (!dp) { dp = swl; }
-	for (; sh>0; sh--, src=(uint8_t*)src+sp) {
-		uint32_t *s = (uint32_t* __restrict)src;
-		uint32_t *d = (uint32_t* __restrict)dst;
-		for (x=dx=0; x<(sw/2); x++, dx+=6) {
-			pix = s[x];
-			dpix1=(pix & 0x0000FFFF)|(pix<<16);
-			dpix2=(pix & 0xFFFF0000)|(pix>>16);
-			d[dx] = dpix1; d[dx+1] = dpix1; d[dx+2] = dpix1; d[dx+3] = dpix2; d[dx+4] = dpix2; d[dx+5] = dpix2;
-		}
-		if (sw&1) {
-			uint16_t *s16 = (uint16_t*)s;
-			uint16_t pix16 = s16[x*2];
-			dpix1 = pix16|(pix16<<16);
-			d[dx] = dpix1; d[dx+1] = dpix1; d[dx+2] = dpix1;
+	uint32_t swl = sw*bpp;
+	uint32_t dwl = swl*xmul;
+	if (!sp) { sp = swl; } if (!dp) { dp = dwl; }
+	if (xmul==1) {
+		if ((ymul==1)&&(effect==EFFECT_NONE)&&(swl==sp)&&(sp==dp)) { memcpy(dst, src, sp*sh); return; }
+		if (dwl>dp) dwl = dp;
+	}
+	uint32_t k = effect!=EFFECT_GRID ? 0 : (bpp==2 ? grid_tint16 : grid_tint32);
+	if (xmul==2 && ymul==2 && effect!=EFFECT_NONE) {
+		// the common 2x effects write both rows in a single pass
+		int lead0 = effect==EFFECT_GRID ? DIM_LIGHT : DIM_NONE;
+		int rest0 = effect==EFFECT_GRID ? DIM_LIGHT : DIM_NONE;
+		int lead1 = effect==EFFECT_GRID ? DIM_LIGHT : DIM_MEDIUM;
+		int rest1 = effect==EFFECT_GRID ? DIM_NONE  : DIM_MEDIUM;
+		for (uint32_t y=0; y<sh; y++, src=(uint8_t*)src+sp, dst=(uint8_t*)dst+dp*2) {
+			if (bpp==2) {
+				uint16_t* __restrict s = src;
+				uint16_t* __restrict d0 = dst;
+				uint16_t* __restrict d1 = (uint16_t*)((uint8_t*)dst+dp);
+				for (uint32_t x=0; x<sw; x++, d0+=2, d1+=2) {
+					uint16_t c = s[x];
+					d0[0] = dim16(c,lead0,k); d0[1] = dim16(c,rest0,k);
+					d1[0] = dim16(c,lead1,k); d1[1] = dim16(c,rest1,k);
+				}
+			}
+			else {
+				uint32_t* __restrict s = src;
+				uint32_t* __restrict d0 = dst;
+				uint32_t* __restrict d1 = (uint32_t*)((uint8_t*)dst+dp);
+				for (uint32_t x=0; x<sw; x++, d0+=2, d1+=2) {
+					uint32_t c = s[x];
+					d0[0] = dim32(c,lead0,k); d0[1] = dim32(c,rest0,k);
+					d1[0] = dim32(c,lead1,k); d1[1] = dim32(c,rest1,k);
+				}
+			}
 		}
-		void* __restrict dstsrc = dst; dst = (uint8_t*)dst+dp;
-		for (uint32_t i=ymul-1; i>0; i--, dst=(uint8_t*)dst+dp) memcpy(dst, dstsrc, swl);
+		return;
 	}
-}
-
-void scale6x1_c16(void* __restrict src, void* __restrict dst, uint32_t sw, uint32_t sh, uint32_t sp, uint32_t dw, uint32_t dh, uint32_t dp) {
-	scale6x_c16(src, dst, sw, sh, sp, dw, dh, dp, 1); }
-void scale6x2_c16(void* __restrict src, void* __restrict dst, uint32_t sw, uint32_t sh, uint32_t sp, uint32_t dw, uint32_t dh, uint32_t dp) {
-	scale6x_c16(src, dst, sw, sh, sp, dw, dh, dp, 2); }
-void scale6x3_c16(void* __restrict src, void* __restrict dst, uint32_t sw, uint32_t sh, uint32_t sp, uint32_t dw, uint32_t dh, uint32_t dp) {
-	scale6x_c16(src, dst, sw, sh, sp, dw, dh, dp, 3); }
-void scale6x4_c16(void* __restrict src, void* __restrict dst, uint32_t sw, uint32_t sh, uint32_t sp, uint32_t dw, uint32_t dh, uint32_t dp) {
-	scale6x_c16(src, dst, sw, sh, sp, dw, dh, dp, 4); }
-void scale6x5_c16(void* __restrict src, void* __restrict dst, uint32_t sw, uint32_t sh, uint32_t sp, uint32_t dw, uint32_t dh, uint32_t dp) {
-	scale6x_c16(src, dst, sw, sh, sp, dw, dh, dp, 5); }
-void scale6x6_c16(void* __restrict src, void* __restrict dst, uint32_t sw, uint32_t sh, uint32_t sp, uint32_t dw, uint32_t dh, uint32_t dp) {
-	scale6x_c16(src, dst, sw, sh, sp, dw, dh, dp, 6); }
-
-void scale6x_c32(void* __restrict src, void* __restrict dst, uint32_t sw, uint32_t sh, uint32_t sp, uint32_t dw, uint32_t dh, uint32_t dp, uint32_t ymul) {
-	if (!sw||!sh||!ymul) return;
-	uint32_t x, dx, pix, swl = sw*sizeof(uint32_t);
-	if (!sp) { sp = swl; } swl*=6; if (!dp) { dp = swl; }
-	for (; sh>0; sh--, src=(uint8_t*)src+sp) {
-		uint32_t *s = (uint32_t* __restrict)src;
-		uint32_t *d = (uint32_t* __restrict)dst;
-		for (x=dx=0; x<sw; x++, dx+=6) {
-			pix = s[x];
-			d[dx] = pix; d[dx+1] = pix; d[dx+2] = pix; d[dx+3] = pix; d[dx+4] = pix; d[dx+5] = pix;
+	// on the stack, the scalers are called from both the core and the flip thread
+	uint8_t scratch[effect==EFFECT_NONE ? 1 : swl*(DIM_COUNT-1)];
+	for (uint32_t y=0; y<sh; y++, src=(uint8_t*)src+sp) {
+		// each level is applied to the src row once and identical
+		// rows within the block are only scaled once
+		void* lines[DIM_COUNT] = { src };
+		void* rows[DIM_COUNT*DIM_COUNT] = { 0 };
+		for (uint32_t r=0; r<ymul; r++, dst=(uint8_t*)dst+dp) {
+			int lead = DIM_NONE;
+			int rest = DIM_NONE;
+			if (effect!=EFFECT_NONE) effect_levels(effect, xmul, ymul, ymul==1 ? y : r, &lead, &rest);
+			
+			void** row = &rows[lead*DIM_COUNT+rest];
+			if (*row) { memcpy(dst, *row, dwl); continue; }
+			*row = dst;
+			
+			if (!lines[lead]) lines[lead] = dim_line(scratch, src, sw, bpp, lead, k);
+			if (!lines[rest]) lines[rest] = dim_line(scratch, src, sw, bpp, rest, k);
+			if (xmul==1) memcpy(dst, lines[lead], dwl);
+			else if (bpp==2) scale_row16(dst, lines[lead], lines[rest], sw, xmul);
+			else scale_row32(dst, lines[lead], lines[rest], sw, xmul);
 		}
-		void* __restrict dstsrc = dst; dst = (uint8_t*)dst+dp;
-		for (uint32_t i=ymul-1; i>0; i--, dst=(uint8_t*)dst+dp) memcpy(dst, dstsrc, swl);
 	}
 }
 
-void scale6x1_c32(void* __restrict src, void* __restrict dst, uint32_t sw, uint32_t sh, uint32_t sp, uint32_t dw, uint32_t dh, uint32_t dp) {
-	scale6x_c32(src, dst, sw, sh, sp, dw, dh, dp, 1); }
-void scale6x2_c32(void* __restrict src, void* __restrict dst, uint32_t sw, uint32_t sh, uint32_t sp, uint32_t dw, uint32_t dh, uint32_t dp) {
-	scale6x_c32(src, dst, sw, sh, sp, dw, dh, dp, 2); }
-void scale6x3_c32(void* __restrict src, void* __restrict dst, uint32_t sw, uint32_t sh, uint32_t sp, uint32_t dw, uint32_t dh, uint32_t dp) {
-	scale6x_c32(src, dst, sw, sh, sp, dw, dh, dp, 3); }
-void scale6x4_c32(void* __restrict src, void* __restrict dst, uint32_t sw, uint32_t sh, uint32_t sp, uint32_t dw, uint32_t dh, uint32_t dp) {
-	scale6x_c32(src, dst, sw, sh, sp, dw, dh, dp, 4); }
-void scale6x5_c32(void* __restrict src, void* __restrict dst, uint32_t sw, uint32_t sh, uint32_t sp, uint32_t dw, uint32_t dh, uint32_t dp) {
-	scale6x_c32(src, dst, sw, sh, sp, dw, dh, dp, 5); }
-void scale6x6_c32(void* __restrict src, void* __restrict dst, uint32_t sw, uint32_t sh, uint32_t sp, uint32_t dw, uint32_t dh, uint32_t dp) {
-	scale6x_c32(src, dst, sw, sh, sp, dw, dh, dp, 6); }
+// one kernel per xmul, bpp and effect, ymul is cheap to leave dynamic
+#define SCALE_C_KERNELS(X) \
+static void scale##X##x_none_c16(void* __restrict src, void* __restrict dst, uint32_t sw, uint32_t sh, uint32_t sp, uint32_t dp, uint32_t ymul) { \
+	scale_c(src, dst, sw, sh, sp, dp, ymul, 2, X, EFFECT_NONE); } \
+static void scale##X##x_none_c32(void* __restrict src, void* __restrict dst, uint32_t sw, uint32_t sh, uint32_t sp, uint32_t dp, uint32_t ymul) { \
+	scale_c(src, dst, sw, sh, sp, dp, ymul, 4, X, EFFECT_NONE); } \
+static void scale##X##x_line_c16(void* __restrict src, void* __restrict dst, uint32_t sw, uint32_t sh, uint32_t sp, uint32_t dp, uint32_t ymul) { \
+	scale_c(src, dst, sw, sh, sp, dp, ymul, 2, X, EFFECT_LINE); } \
+static void scale##X##x_line_c32(void* __restrict src, void* __restrict dst, uint32_t sw, uint32_t sh, uint32_t sp, uint32_t dp, uint32_t ymul) { \
+	scale_c(src, dst, sw, sh, sp, dp, ymul, 4, X, EFFECT_LINE); } \
+static void scale##X##x_grid_c16(void* __restrict src, void* __restrict dst, uint32_t sw, uint32_t sh, uint32_t sp, uint32_t dp, uint32_t ymul) { \
+	scale_c(src, dst, sw, sh, sp, dp, ymul, 2, X, EFFECT_GRID); } \
+static void scale##X##x_grid_c32(void* __restrict src, void* __restrict dst, uint32_t sw, uint32_t sh, uint32_t sp, uint32_t dp, uint32_t ymul) { \
+	scale_c(src, dst, sw, sh, sp, dp, ymul, 4, X, EFFECT_GRID); } \
+void scale##X##x_c16(void* __restrict src, void* __restrict dst, uint32_t sw, uint32_t sh, uint32_t sp, uint32_t dw, uint32_t dh, uint32_t dp, uint32_t ymul) { \
+	scale##X##x_none_c16(src, dst, sw, sh, sp, dp, ymul); } \
+void scale##X##x_c32(void* __restrict src, void* __restrict dst, uint32_t sw, uint32_t sh, uint32_t sp, uint32_t dw, uint32_t dh, uint32_t dp, uint32_t ymul) { \
+	scale##X##x_none_c32(src, dst, sw, sh, sp, dp, ymul); }
+
+SCALE_C_KERNELS(1)
+SCALE_C_KERNELS(2)
+SCALE_C_KERNELS(3)
+SCALE_C_KERNELS(4)
+SCALE_C_KERNELS(5)
+SCALE_C_KERNELS(6)
+SCALE_C_KERNELS(7)
+SCALE_C_KERNELS(8)
+
+#define SCALE_C(X,Y) \
+void scale##X##x##Y##_c16(void* __restrict src, void* __restrict dst, uint32_t sw, uint32_t sh, uint32_t sp, uint32_t dw, uint32_t dh, uint32_t dp) { \
+	scale##X##x_none_c16(src, dst, sw, sh, sp, dp, Y); } \
+void scale##X##x##Y##_c32(void* __restrict src, void* __restrict dst, uint32_t sw, uint32_t sh, uint32_t sp, uint32_t dw, uint32_t dh, uint32_t dp) { \
+	scale##X##x_none_c32(src, dst, sw, sh, sp, dp, Y); } \
+void scale##X##x##Y##_line_c16(void* __restrict src, void* __restrict dst, uint32_t sw, uint32_t sh, uint32_t sp, uint32_t dw, uint32_t dh, uint32_t dp) { \
+	scale##X##x_line_c16(src, dst, sw, sh, sp, dp, Y); } \
+void scale##X##x##Y##_line_c32(void* __restrict src, void* __restrict dst, uint32_t sw, uint32_t sh, uint32_t sp, uint32_t dw, uint32_t dh, uint32_t dp) { \
+	scale##X##x_line_c32(src, dst, sw, sh, sp, dp, Y); } \
+void scale##X##x##Y##_grid_c16(void* __restrict src, void* __restrict dst, uint32_t sw, uint32_t sh, uint32_t sp, uint32_t dw, uint32_t dh, uint32_t dp) { \
+	scale##X##x_grid_c16(src, dst, sw, sh, sp, dp, Y); } \
+void scale##X##x##Y##_grid_c32(void* __restrict src, void* __restrict dst, uint32_t sw, uint32_t sh, uint32_t sp, uint32_t dw, uint32_t dh, uint32_t dp) { \
+	scale##X##x_grid_c32(src, dst, sw, sh, sp, dp, Y); }
+#define SCALE_C_X(X) SCALE_C(X,1) SCALE_C(X,2) SCALE_C(X,3) SCALE_C(X,4) SCALE_C(X,5) SCALE_C(X,6) SCALE_C(X,7) SCALE_C(X,8)
+
+SCALE_C_X(1)
+SCALE_C_X(2)
+SCALE_C_X(3)
+SCALE_C_X(4)
+SCALE_C_X(5)
+SCALE_C_X(6)
+SCALE_C_X(7)
+SCALE_C_X(8)
+
+#define SCALE_C_ROW(X,fx) { &scale##X##x1##fx, &scale##X##x2##fx, &scale##X##x3##fx, &scale##X##x4##fx, &scale##X##x5##fx, &scale##X##x6##fx, &scale##X##x7##fx, &scale##X##x8##fx }
+#define SCALE_C_TABLE(fx) { SCALE_C_ROW(1,fx), SCALE_C_ROW(2,fx), SCALE_C_ROW(3,fx), SCALE_C_ROW(4,fx), SCALE_C_ROW(5,fx), SCALE_C_ROW(6,fx), SCALE_C_ROW(7,fx), SCALE_C_ROW(8,fx) }
+
+static const scaler_t scalers_c16[EFFECT_COUNT][SCALER_MAX_MUL][SCALER_MAX_MUL] = {
+	SCALE_C_TABLE(_c16),
+	SCALE_C_TABLE(_line_c16),
+	SCALE_C_TABLE(_grid_c16),
+};
+static const scaler_t scalers_c32[EFFECT_COUNT][SCALER_MAX_MUL][SCALER_MAX_MUL] = {
+	SCALE_C_TABLE(_c32),
+	SCALE_C_TABLE(_line_c32),
+	SCALE_C_TABLE(_grid_c32),
+};
 
 #ifdef HAS_NEON
 
@@ -2837,237 +2752,54 @@ void scale6x5_n32(void* __restrict src, void* __restrict dst, uint32_t sw, uint3
 void scale6x6_n32(void* __restrict src, void* __restrict dst, uint32_t sw, uint32_t sh, uint32_t sp, uint32_t dw, uint32_t dh, uint32_t dp) {
 	scale6x_n32(src, dst, sw, sh, sp, dw, dh, dp, 6); }
 
+static const scaler_t scalers_n16[6][6] = {
+	{ &scale1x1_n16, &scale1x2_n16, &scale1x3_n16, &scale1x4_n16, NULL, NULL },
+	{ &scale2x1_n16, &scale2x2_n16, &scale2x3_n16, &scale2x4_n16, NULL, NULL },
+	{ &scale3x1_n16, &scale3x2_n16, &scale3x3_n16, &scale3x4_n16, NULL, NULL },
+	{ &scale4x1_n16, &scale4x2_n16, &scale4x3_n16, &scale4x4_n16, NULL, NULL },
+	{ &scale5x1_n16, &scale5x2_n16, &scale5x3_n16, &scale5x4_n16, &scale5x5_n16, NULL },
+	{ &scale6x1_n16, &scale6x2_n16, &scale6x3_n16, &scale6x4_n16, &scale6x5_n16, &scale6x6_n16 }
+};
+static const scaler_t scalers_n32[6][6] = {
+	{ &scale1x1_n32, &scale1x2_n32, &scale1x3_n32, &scale1x4_n32, NULL, NULL },
+	{ &scale2x1_n32, &scale2x2_n32, &scale2x3_n32, &scale2x4_n32, NULL, NULL },
+	{ &scale3x1_n32, &scale3x2_n32, &scale3x3_n32, &scale3x4_n32, NULL, NULL },
+	{ &scale4x1_n32, &scale4x2_n32, &scale4x3_n32, &scale4x4_n32, NULL, NULL },
+	{ &scale5x1_n32, &scale5x2_n32, &scale5x3_n32, &scale5x4_n32, &scale5x5_n32, NULL },
+	{ &scale6x1_n32, &scale6x2_n32, &scale6x3_n32, &scale6x4_n32, &scale6x5_n32, &scale6x6_n32 }
+};
+
 void scaler_n16(uint32_t xmul, uint32_t ymul, void* __restrict src, void* __restrict dst, uint32_t sw, uint32_t sh, uint32_t sp, uint32_t dw, uint32_t dh, uint32_t dp) {
-	void (* const func[6][8])(void* __restrict, void* __restrict, uint32_t, uint32_t, uint32_t, uint32_t, uint32_t, uint32_t) = {
-			{ &scale1x1_n16, &scale1x2_n16, &scale1x3_n16, &scale1x4_n16, &dummy, &dummy, &dummy, &dummy },
-			{ &scale2x1_n16, &scale2x2_n16, &scale2x3_n16, &scale2x4_n16, &dummy, &dummy, &dummy, &dummy },
-			{ &scale3x1_n16, &scale3x2_n16, &scale3x3_n16, &scale3x4_n16, &dummy, &dummy, &dummy, &dummy },
-			{ &scale4x1_n16, &scale4x2_n16, &scale4x3_n16, &scale4x4_n16, &dummy, &dummy, &dummy, &dummy },
-			{ &scale5x1_n16, &scale5x2_n16, &scale5x3_n16, &scale5x4_n16, &scale5x5_n16, &dummy, &dummy, &dummy },
-			{ &scale6x1_n16, &scale6x2_n16, &scale6x3_n16, &scale6x4_n16, &scale6x5_n16, &scale6x6_n16, &dummy, &dummy }
-		   };
-	if ((--xmul < 6)&&(--ymul < 6)) func[xmul][ymul](src, dst, sw, sh, sp, dw, dh, dp);
-	return;
+	scaler_lookup(16, EFFECT_NONE, xmul, ymul)(src, dst, sw, sh, sp, dw, dh, dp);
 }
 
 void scaler_n32(uint32_t xmul, uint32_t ymul, void* __restrict src, void* __restrict dst, uint32_t sw, uint32_t sh, uint32_t sp, uint32_t dw, uint32_t dh, uint32_t dp) {
-	void (* const func[6][8])(void* __restrict, void* __restrict, uint32_t, uint32_t, uint32_t, uint32_t, uint32_t, uint32_t) = {
-			{ &scale1x1_n32, &scale1x2_n32, &scale1x3_n32, &scale1x4_n32, &dummy, &dummy, &dummy, &dummy },
-			{ &scale2x1_n32, &scale2x2_n32, &scale2x3_n32, &scale2x4_n32, &dummy, &dummy, &dummy, &dummy },
-			{ &scale3x1_n32, &scale3x2_n32, &scale3x3_n32, &scale3x4_n32, &dummy, &dummy, &dummy, &dummy },
-			{ &scale4x1_n32, &scale4x2_n32, &scale4x3_n32, &scale4x4_n32, &dummy, &dummy, &dummy, &dummy },
-			{ &scale5x1_n32, &scale5x2_n32, &scale5x3_n32, &scale5x4_n32, &scale5x5_n32, &dummy, &dummy, &dummy },
-			{ &scale6x1_n32, &scale6x2_n32, &scale6x3_n32, &scale6x4_n32, &scale6x5_n32, &scale6x6_n32, &dummy, &dummy }
-		   };
-	if ((--xmul < 6)&&(--ymul < 6)) func[xmul][ymul](src, dst, sw, sh, sp, dw, dh, dp);
-	return;
+	scaler_lookup(32, EFFECT_NONE, xmul, ymul)(src, dst, sw, sh, sp, dw, dh, dp);
 }
 
 #endif
 
 void scaler_c16(uint32_t xmul, uint32_t ymul, void* __restrict src, void* __restrict dst, uint32_t sw, uint32_t sh, uint32_t sp, uint32_t dw, uint32_t dh, uint32_t dp) {
-	void (* const func[6][8])(void* __restrict, void* __restrict, uint32_t, uint32_t, uint32_t, uint32_t, uint32_t, uint32_t) = {
-			{ &scale1x1_c16, &scale1x2_c16, &scale1x3_c16, &scale1x4_c16, &dummy, &dummy, &dummy, &dummy },
-			{ &scale2x1_c16, &scale2x2_c16, &scale2x3_c16, &scale2x4_c16, &dummy, &dummy, &dummy, &dummy },
-			{ &scale3x1_c16, &scale3x2_c16, &scale3x3_c16, &scale3x4_c16, &dummy, &dummy, &dummy, &dummy },
-			{ &scale4x1_c16, &scale4x2_c16, &scale4x3_c16, &scale4x4_c16, &dummy, &dummy, &dummy, &dummy },
-			{ &scale5x1_c16, &scale5x2_c16, &scale5x3_c16, &scale5x4_c16, &scale5x5_c16, &dummy, &dummy, &dummy },
-			{ &scale6x1_c16, &scale6x2_c16, &scale6x3_c16, &scale6x4_c16, &scale6x5_c16, &scale6x6_c16, &dummy, &dummy }
-		   };
-	if ((--xmul < 6)&&(--ymul < 6)) func[xmul][ymul](src, dst, sw, sh, sp, dw, dh, dp);
+	if ((--xmul < SCALER_MAX_MUL)&&(--ymul < SCALER_MAX_MUL)) scalers_c16[EFFECT_NONE][xmul][ymul](src, dst, sw, sh, sp, dw, dh, dp);
 	return;
 }
 
 void scaler_c32(uint32_t xmul, uint32_t ymul, void* __restrict src, void* __restrict dst, uint32_t sw, uint32_t sh, uint32_t sp, uint32_t dw, uint32_t dh, uint32_t dp) {
-	void (* const func[6][8])(void* __restrict, void* __restrict, uint32_t, uint32_t, uint32_t, uint32_t, uint32_t, uint32_t) = {
-			{ &scale1x1_c32, &scale1x2_c32, &scale1x3_c32, &scale1x4_c32, &dummy, &dummy, &dummy, &dummy },
-			{ &scale2x1_c32, &scale2x2_c32, &scale2x3_c32, &scale2x4_c32, &dummy, &dummy, &dummy, &dummy },
-			{ &scale3x1_c32, &scale3x2_c32, &scale3x3_c32, &scale3x4_c32, &dummy, &dummy, &dummy, &dummy },
-			{ &scale4x1_c32, &scale4x2_c32, &scale4x3_c32, &scale4x4_c32, &dummy, &dummy, &dummy, &dummy },
-			{ &scale5x1_c32, &scale5x2_c32, &scale5x3_c32, &scale5x4_c32, &scale5x5_c32, &dummy, &dummy, &dummy },
-			{ &scale6x1_c32, &scale6x2_c32, &scale6x3_c32, &scale6x4_c32, &scale6x5_c32, &scale6x6_c32, &dummy, &dummy }
-		   };
-	if ((--xmul < 6)&&(--ymul < 6)) func[xmul][ymul](src, dst, sw, sh, sp, dw, dh, dp);
+	if ((--xmul < SCALER_MAX_MUL)&&(--ymul < SCALER_MAX_MUL)) scalers_c32[EFFECT_NONE][xmul][ymul](src, dst, sw, sh, sp, dw, dh, dp);
 	return;
 }
 
-
-// from gambatte-dms
-//from RGB565
-#define cR(A) (((A) & 0xf800) >> 11)
-#define cG(A) (((A) & 0x7e0) >> 5)
-#define cB(A) ((A) & 0x1f)
-//to RGB565
-#define Weight2_3(A, B)  (((((cR(A) << 1) + (cR(B) * 3)) / 5) & 0x1f) << 11 | ((((cG(A) << 1) + (cG(B) * 3)) / 5) & 0x3f) << 5 | ((((cB(A) << 1) + (cB(B) * 3)) / 5) & 0x1f))
-#define Weight3_1(A, B)  ((((cR(B) + (cR(A) * 3)) >> 2) & 0x1f) << 11 | (((cG(B) + (cG(A) * 3)) >> 2) & 0x3f) << 5 | (((cB(B) + (cB(A) * 3)) >> 2) & 0x1f))
-#define Weight3_2(A, B)  (((((cR(B) << 1) + (cR(A) * 3)) / 5) & 0x1f) << 11 | ((((cG(B) << 1) + (cG(A) * 3)) / 5) & 0x3f) << 5 | ((((cB(B) << 1) + (cB(A) * 3)) / 5) & 0x1f))
-
-#define MIN(a, b) (a) < (b) ? (a) : (b)
-void scale1x_line(void* __restrict src, void* __restrict dst, uint32_t sw, uint32_t sh, uint32_t sp, uint32_t dw, uint32_t dh, uint32_t dp) {
-	// pitch of src image not src buffer!
-	// eg. gb has a 160 pixel wide image but 
-	// gambatte uses a 256 pixel wide buffer
-	// (only matters when using memcpy) 
-	int ip = sw * FIXED_BPP; 
-	int src_stride = 2 * sp / FIXED_BPP;
-	int dst_stride = 2 * dp / FIXED_BPP;
-	int cpy_pitch = MIN(ip, dp);
-	
-	uint16_t k = 0x0000;
-	uint16_t* restrict src_row = (uint16_t*)src;
-	uint16_t* restrict dst_row = (uint16_t*)dst;
-	for (int y=0; y<sh; y+=2) {
-		memcpy(dst_row, src_row, cpy_pitch);
-		dst_row += dst_stride;
-		src_row += src_stride;
-		for (unsigned x=0; x<sw; x++) {
-			uint16_t s = *(src_row + x);
-			*(dst_row + x) = Weight3_1(s, k);
-		}
-	}
-}
-void scale2x_line(void* __restrict src, void* __restrict dst, uint32_t sw, uint32_t sh, uint32_t sp, uint32_t dw, uint32_t dh, uint32_t dp) {
-	dw = dp / 2;
-	uint16_t k = 0x0000;
-	for (unsigned y=0; y<sh; y++) {
-		uint16_t* restrict src_row = (void*)src + y * sp;
-		uint16_t* restrict dst_row = (void*)dst + y * dp * 2;
-		for (unsigned x=0; x<sw; x++) {
-			uint16_t c1 = *src_row;
-			uint16_t c2 = Weight3_2( c1, k);
-			
-			*(dst_row     ) = c1;
-			*(dst_row + 1 ) = c1;
-			
-			*(dst_row + dw    ) = c2;
-			*(dst_row + dw + 1) = c2;
-			
-			src_row += 1;
-			dst_row += 2;
-		}
-	}
-}
-void scale3x_line(void* __restrict src, void* __restrict dst, uint32_t sw, uint32_t sh, uint32_t sp, uint32_t dw, uint32_t dh, uint32_t dp) {
-	dw = dp / 2;
-	uint16_t k = 0x0000;
-	for (unsigned y=0; y<sh; y++) {
-		uint16_t* restrict src_row = (void*)src + y * sp;
-		uint16_t* restrict dst_row = (void*)dst + y * dp * 3;
-		for (unsigned x=0; x<sw; x++) {
-			uint16_t c1 = *src_row;
-			uint16_t c2 = Weight3_2( c1, k);
-			
-			// row 1
-			*(dst_row             ) = c2;
-			*(dst_row          + 1) = c2;
-			*(dst_row          + 2) = c2;
-
-			// row 2
-			*(dst_row + dw * 1    ) = c1;
-			*(dst_row + dw * 1 + 1) = c1;
-			*(dst_row + dw * 1 + 2) = c1;
-
-			// row 3
-			*(dst_row + dw * 2    ) = c1;
-			*(dst_row + dw * 2 + 1) = c1;
-			*(dst_row + dw * 2 + 2) = c1;
-
-			src_row += 1;
-			dst_row += 3;
-		}
-	}
-}
-void scale4x_line(void* __restrict src, void* __restrict dst, uint32_t sw, uint32_t sh, uint32_t sp, uint32_t dw, uint32_t dh, uint32_t dp) {
-	dw = dp / 2;
-	int row3 = dw * 2;
-	int row4 = dw * 3;
-	uint16_t k = 0x0000;
-	for (unsigned y=0; y<sh; y++) {
-		uint16_t* restrict src_row = (void*)src + y * sp;
-		uint16_t* restrict dst_row = (void*)dst + y * dp * 4;
-		for (unsigned x=0; x<sw; x++) {
-			uint16_t c1 = *src_row;
-			uint16_t c2 = Weight3_2( c1, k);
-			
-			// row 1
-			*(dst_row    ) = c1;
-			*(dst_row + 1) = c1;
-			*(dst_row + 2) = c1;
-			*(dst_row + 3) = c1;
-			
-			// row 2
-			*(dst_row + dw    ) = c2;
-			*(dst_row + dw + 1) = c2;
-			*(dst_row + dw + 2) = c2;
-			*(dst_row + dw + 3) = c2;
-
-			// row 3
-			*(dst_row + row3    ) = c1;
-			*(dst_row + row3 + 1) = c1;
-			*(dst_row + row3 + 2) = c1;
-			*(dst_row + row3 + 3) = c1;
-
-			// row 4
-			*(dst_row + row4    ) = c2;
-			*(dst_row + row4 + 1) = c2;
-			*(dst_row + row4 + 2) = c2;
-			*(dst_row + row4 + 3) = c2;
-
-			src_row += 1;
-			dst_row += 4;
-		}
-	}
-}
-
-void scale2x_grid(void* __restrict src, void* __restrict dst, uint32_t sw, uint32_t sh, uint32_t sp, uint32_t dw, uint32_t dh, uint32_t dp) {
-	dw = dp / 2;
-	uint16_t k = 0x0000;
-	for (unsigned y=0; y<sh; y++) {
-		uint16_t* restrict src_row = (void*)src + y * sp;
-		uint16_t* restrict dst_row = (void*)dst + y * dp * 2;
-		for (unsigned x=0; x<sw; x++) {
-			uint16_t c1 = *src_row;
-			uint16_t c2 = Weight3_1( c1, k);
-			
-			*(dst_row     ) = c2;
-			*(dst_row + 1 ) = c2;
-			
-			*(dst_row + dw    ) = c2;
-			*(dst_row + dw + 1) = c1;
-			
-			src_row += 1;
-			dst_row += 2;
-		}
+scaler_t scaler_lookup(uint32_t bpp, uint32_t effect, uint32_t xmul, uint32_t ymul) {
+	// like the old per platform switches anything out of range is 1x
+	if (effect>=EFFECT_COUNT) effect = EFFECT_NONE;
+	if (--xmul>=SCALER_MAX_MUL) xmul = 0;
+	if (--ymul>=SCALER_MAX_MUL) ymul = 0;
+#ifdef HAS_NEON
+	// the hand written NEON kernels still win for plain scaling
+	if (effect==EFFECT_NONE && xmul<6 && ymul<6) {
+		scaler_t scaler = bpp==32 ? scalers_n32[xmul][ymul] : scalers_n16[xmul][ymul];
+		if (scaler) return scaler;
 	}
+#endif
+	return bpp==32 ? scalers_c32[effect][xmul][ymul] : scalers_c16[effect][xmul][ymul];
 }
-void scale3x_grid(void* __restrict src, void* __restrict dst, uint32_t sw, uint32_t sh, uint32_t sp, uint32_t dw, uint32_t dh, uint32_t dp) {
-	dw = dp / 2;
-	uint16_t k = 0x0000;
-	for (unsigned y=0; y<sh; y++) {
-		uint16_t* restrict src_row = (void*)src + y * sp;
-		uint16_t* restrict dst_row = (void*)dst + y * dp * 3;
-		for (unsigned x=0; x<sw; x++) {
-			uint16_t c1 = *src_row;
-			uint16_t c2 = Weight3_2( c1, k);
-			uint16_t c3 = Weight2_3( c1, k);
-			
-			// row 1
-			*(dst_row                       ) = c2;
-			*(dst_row                    + 1) = c1;
-			*(dst_row                    + 2) = c1;
-
-			// row 2
-			*(dst_row + dw * 1    ) = c2;
-			*(dst_row + dw * 1 + 1) = c1;
-			*(dst_row + dw * 1 + 2) = c1;
-
-			// row 3
-			*(dst_row + dw * 2    ) = c3;
-			*(dst_row + dw * 2 + 1) = c2;
-			*(dst_row + dw * 2 + 2) = c2;
-
-			src_row += 1;
-			dst_row += 3;
-		}
-	}
-}
\ No newline at end of file
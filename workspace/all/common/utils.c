@@ -7,6 +7,7 @@
 #include <math.h>
 #include <ctype.h>
 #include <sys/time.h>
+#include <time.h>
 #include "defines.h"
 #include "utils.h"
 
@@ -202,4 +203,186 @@ uint64_t getMicroseconds(void) {
     ret += (uint64_t)tv.tv_usec;
 
     return ret;
-}
\ No newline at end of file
+}
+
+///////////////////////////////////////
+
+// open addressing with linear probing, keys and values are packed
+// into large blocks so loading a map.txt doesn't malloc every line
+
+#define HASH_ARENA_SIZE (16 * 1024)
+
+typedef struct HashArena {
+	struct HashArena* next;
+	size_t used;
+	size_t size;
+	char data[];
+} HashArena;
+
+typedef struct HashSlot {
+	uint32_t hash;
+	char* key; // NULL when empty
+	char* value;
+} HashSlot;
+
+struct Hash {
+	int count;
+	int capacity; // always a power of 2
+	HashSlot* slots;
+	HashArena* arena;
+};
+
+static uint32_t Hash_hash(char* key) { // fnv-1a
+	uint32_t hash = 2166136261u;
+	while (*key) {
+		hash ^= (uint8_t)*key++;
+		hash *= 16777619u;
+	}
+	return hash;
+}
+static char* Hash_copy(Hash* self, char* str) {
+	size_t len = strlen(str) + 1;
+	HashArena* arena = self->arena;
+	if (!arena || arena->used+len>arena->size) {
+		size_t size = len>HASH_ARENA_SIZE ? len : HASH_ARENA_SIZE;
+		arena = malloc(sizeof(HashArena) + size);
+		arena->next = self->arena;
+		arena->used = 0;
+		arena->size = size;
+		self->arena = arena;
+	}
+	char* copy = arena->data + arena->used;
+	memcpy(copy, str, len);
+	arena->used += len;
+	return copy;
+}
+static HashSlot* Hash_find(HashSlot* slots, int capacity, uint32_t hash, char* key) {
+	int mask = capacity - 1;
+	int i = hash & mask;
+	while (slots[i].key && (slots[i].hash!=hash || strcmp(slots[i].key, key))) {
+		i = (i + 1) & mask;
+	}
+	return &slots[i];
+}
+static void Hash_grow(Hash* self) {
+	int capacity = self->capacity * 2;
+	HashSlot* slots = calloc(capacity, sizeof(HashSlot));
+	for (int i=0; i<self->capacity; i++) {
+		HashSlot* slot = &self->slots[i];
+		if (slot->key) *Hash_find(slots, capacity, slot->hash, slot->key) = *slot;
+	}
+	free(self->slots);
+	self->slots = slots;
+	self->capacity = capacity;
+}
+
+Hash* Hash_new(void) {
+	Hash* self = malloc(sizeof(Hash));
+	self->count = 0;
+	self->capacity = 64;
+	self->slots = calloc(self->capacity, sizeof(HashSlot));
+	self->arena = NULL;
+	return self;
+}
+Hash* Hash_load(char* map_path) {
+	FILE* file = fopen(map_path, "r");
+	if (!file) return NULL;
+	
+	Hash* self = Hash_new();
+	char line[256];
+	while (fgets(line,256,file)!=NULL) {
+		normalizeNewline(line);
+		trimTrailingNewlines(line);
+		if (strlen(line)==0) continue; // skip empty lines
+
+		char* tmp = strchr(line,'\t');
+		if (tmp) {
+			tmp[0] = '\0';
+			char* key = line;
+			char* value = tmp+1;
+			Hash_set(self, key, value);
+		}
+	}
+	fclose(file);
+	return self;
+}
+void Hash_free(Hash* self) {
+	HashArena* arena = self->arena;
+	while (arena) {
+		HashArena* next = arena->next;
+		free(arena);
+		arena = next;
+	}
+	free(self->slots);
+	free(self);
+}
+void Hash_set(Hash* self, char* key, char* value) {
+	if ((self->count+1)*4>self->capacity*3) Hash_grow(self); // keep it under 3/4 full
+	
+	uint32_t hash = Hash_hash(key);
+	HashSlot* slot = Hash_find(self->slots, self->capacity, hash, key);
+	if (slot->key) return;
+	
+	slot->hash = hash;
+	slot->key = Hash_copy(self, key);
+	slot->value = Hash_copy(self, value);
+	self->count += 1;
+}
+char* Hash_get(Hash* self, char* key) {
+	HashSlot* slot = Hash_find(self->slots, self->capacity, Hash_hash(key), key);
+	return slot->key ? slot->value : NULL;
+}
+
+///////////////////////////////////////
+
+#define TRACE_MAX 32
+static struct Trace {
+	int enabled;
+	char* name;
+	uint64_t start;
+	int count;
+	char* phases[TRACE_MAX];
+	uint64_t times[TRACE_MAX];
+} trace;
+
+void TRACE_init(char* name) {
+	char* env = getenv("MINUI_TRACE");
+	trace.enabled = (env && !exactMatch(env, "0")) || exists(TRACE_FLAG_PATH);
+	trace.name = name;
+	trace.count = 0;
+	trace.start = getMicroseconds();
+}
+void TRACE_mark(char* phase) {
+	if (!trace.enabled || trace.count==TRACE_MAX) return;
+	trace.phases[trace.count] = phase;
+	trace.times[trace.count] = getMicroseconds();
+	trace.count += 1;
+}
+void TRACE_quit(void) {
+	if (!trace.enabled) return;
+	trace.enabled = 0;
+	
+	// first line is the release name
+	char release[256] = "unknown";
+	if (exists(ROOT_SYSTEM_PATH "/version.txt")) {
+		getFile(ROOT_SYSTEM_PATH "/version.txt", release, sizeof(release));
+		char* tmp = strchr(release, '\n');
+		if (tmp) tmp[0] = '\0';
+	}
+	
+	int is_new = !exists(TRACE_PATH);
+	FILE* file = fopen(TRACE_PATH, "a");
+	if (!file) return;
+	if (is_new) fputs("launched\trelease\tplatform\tprogram\tphase\tat_us\ttook_us\n", file);
+	
+	long launched = time(NULL) - (getMicroseconds() - trace.start) / 1000000;
+	uint64_t last = trace.start;
+	for (int i=0; i<trace.count; i++) {
+		fprintf(file, "%li\t%s\t%s\t%s\t%s\t%lu\t%lu\n", launched, release, PLATFORM, trace.name, trace.phases[i],
+			(unsigned long)(trace.times[i] - trace.start), 
+			(unsigned long)(trace.times[i] - last)
+		);
+		last = trace.times[i];
+	}
+	fclose(file);
+}
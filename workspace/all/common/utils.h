@@ -27,4 +27,18 @@ int getInt(char* path);
 
 uint64_t getMicroseconds(void);
 
+// string to string map, keys and values are copied into the map
+typedef struct Hash Hash;
+Hash* Hash_new(void);
+Hash* Hash_load(char* map_path); // a map.txt, NULL when missing
+void Hash_free(Hash* self);
+void Hash_set(Hash* self, char* key, char* value); // first value set for a key wins
+char* Hash_get(Hash* self, char* key);
+
+// startup tracing, enabled by the MINUI_TRACE env var or TRACE_FLAG_PATH,
+// each traced launch appends a line per phase to TRACE_PATH
+void TRACE_init(char* name); // first thing in main()
+void TRACE_mark(char* phase); // when phase finishes, phase must outlive the trace (a literal)
+void TRACE_quit(void); // writes the log, no marks are taken after this
+
 #endif
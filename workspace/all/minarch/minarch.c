@@ -1646,6 +1646,7 @@ static int setFastForward(int enable) {
 		toggle_thread = 1;
 	}
 	fast_forward = enable;
+	GFX_setTargetFPS(enable ? -1 : core.fps);
 	return enable;
 }
 
@@ -2159,20 +2160,37 @@ static bool environment_callback(unsigned cmd, void *data) { // copied from pico
 
 ///////////////////////////////
 
-static void hdmimon(void) {
+// returns 1 when the menu has to close, every menu loop breaks out on
+// it and the ones that open nested menus check show_menu when they return
+static int hdmimon(void) {
 	// handle HDMI change
 	static int had_hdmi = -1;
 	int has_hdmi = GetHDMI();
 	if (had_hdmi==-1) had_hdmi = has_hdmi;
 	if (has_hdmi!=had_hdmi) {
 		had_hdmi = has_hdmi;
+		
+		// the threaded core could be mid frame so let it restart instead
+		SDL_Surface* output = thread_video ? NULL : GFX_setOutput(has_hdmi);
+		if (output) {
+			screen = output;
+			DEVICE_WIDTH = screen->w;
+			DEVICE_HEIGHT = screen->h;
+			DEVICE_PITCH = screen->pitch;
+			renderer.dst_p = 0; // pick a scaler for the new output
+			show_menu = 0; // its surfaces are sized for the old one
+			LOG_info("switched output after HDMI change (%ix%i)\n", DEVICE_WIDTH,DEVICE_HEIGHT);
+			return 1;
+		}
 
 		LOG_info("restarting after HDMI change...\n");
 		Menu_beforeSleep();
 		sleep(4);
 		show_menu = 0;
 		quit = 1;
+		return 1;
 	}
+	return 0;
 }
 
 ///////////////////////////////
@@ -2504,14 +2522,19 @@ static uint32_t sec_start = 0;
 
 // buffer to convert xrgb8888 to rgb565
 static void* buffer = NULL;
+static int buffer_size = 0;
 static void buffer_dealloc(void) {
 	if (!buffer) return;
 	free(buffer);
 	buffer = NULL;
+	buffer_size = 0;
 }
 static void buffer_realloc(int w, int h, int p) {
+	int size = (w * FIXED_BPP) * h;
+	if (size<=buffer_size) return; // only grows so switching back to a smaller size is free
 	buffer_dealloc();
-	buffer = malloc((w * FIXED_BPP) * h);
+	buffer = malloc(size);
+	buffer_size = size;
 	// LOG_info("buffer_realloc(%i,%i,%i)\n", w,h,p);
 }
 static void buffer_downsample(const void *data, unsigned width, unsigned height, size_t pitch) {
@@ -2533,11 +2556,10 @@ static void buffer_downsample(const void *data, unsigned width, unsigned height,
 	}
 }
 
-static void selectScaler(int src_w, int src_h, int src_p) {
-	LOG_info("selectScaler\n");
-	
-	if (downsample) buffer_realloc(src_w,src_h,src_p);
-	
+// only works out the renderer geometry, no allocation or platform
+// calls, so the result for any src size and scaling mode is the same
+// every time and can be logged and diffed between builds
+static void selectScalerGeometry(GFX_Renderer* r, int src_w, int src_h, int src_p, char* scaler_name) {
 	int src_x,src_y,dst_x,dst_y,dst_w,dst_h,dst_p,scale;
 	double aspect;
 	
@@ -2551,16 +2573,14 @@ static void selectScaler(int src_w, int src_h, int src_p) {
 		aspect_w += aspect_w % 2;
 	}
 
-	char scaler_name[16];
-	
 	src_x = 0;
 	src_y = 0;
 	dst_x = 0;
 	dst_y = 0;
 
 	// unmodified by crop
-	renderer.true_w = src_w;
-	renderer.true_h = src_h;
+	r->true_w = src_w;
+	r->true_h = src_h;
 	
 	// TODO: this is saving non-rgb30 devices from themselves...or rather, me
 	int scaling = screen_scaling;
@@ -2737,30 +2757,102 @@ static void selectScaler(int src_w, int src_h, int src_p) {
 	
 	// LOG_info("aspect: %ix%i (%f)\n", aspect_w,aspect_h,core.aspect_ratio);
 	
-	renderer.src_x = src_x;
-	renderer.src_y = src_y;
-	renderer.src_w = src_w;
-	renderer.src_h = src_h;
-	renderer.src_p = src_p;
-	renderer.dst_x = dst_x;
-	renderer.dst_y = dst_y;
-	renderer.dst_w = dst_w;
-	renderer.dst_h = dst_h;
-	renderer.dst_p = dst_p;
-	renderer.scale = scale;
-	renderer.aspect = (scaling==SCALE_NATIVE||scaling==SCALE_CROPPED)?0:(scaling==SCALE_FULLSCREEN?-1:core.aspect_ratio);
-	LOG_info("aspect: %f\n", renderer.aspect);
-	renderer.blit = GFX_getScaler(&renderer);
-		
-	// LOG_info("coreAR:%0.3f fixedAR:%0.3f srcAR: %0.3f\nname:%s\nfit:%i scale:%i\nsrc_x:%i src_y:%i src_w:%i src_h:%i src_p:%i\ndst_x:%i dst_y:%i dst_w:%i dst_h:%i dst_p:%i\naspect_w:%i aspect_h:%i\n",
-	// 	core.aspect_ratio, ((double)DEVICE_WIDTH) / DEVICE_HEIGHT, ((double)src_w) / src_h,
-	// 	scaler_name,
-	// 	fit,scale,
-	// 	src_x,src_y,src_w,src_h,src_p,
-	// 	dst_x,dst_y,dst_w,dst_h,dst_p,
-	// 	aspect_w,aspect_h
-	// );
+	r->src_x = src_x;
+	r->src_y = src_y;
+	r->src_w = src_w;
+	r->src_h = src_h;
+	r->src_p = src_p;
+	r->dst_x = dst_x;
+	r->dst_y = dst_y;
+	r->dst_w = dst_w;
+	r->dst_h = dst_h;
+	r->dst_p = dst_p;
+	r->scale = scale;
+	r->aspect = (scaling==SCALE_NATIVE||scaling==SCALE_CROPPED)?0:(scaling==SCALE_FULLSCREEN?-1:core.aspect_ratio);
+}
+
+// remembers the geometry of recently seen source sizes so cores that
+// flip between a few resolutions (interlaced menus, hi-res transitions)
+// don't redo the math every switch, anything the geometry depends on
+// is part of the key so there's nothing to invalidate
+#define GEOMETRY_CACHE_SIZE 8
+static struct GeometryCache {
+	int src_w;
+	int src_h;
+	int src_p;
+	int scaling;
+	int device_w;
+	int device_h;
+	double aspect_ratio;
+	GFX_Renderer renderer;
+	char scaler_name[16];
+	uint32_t used;
+} geometry_cache[GEOMETRY_CACHE_SIZE];
+static uint32_t geometry_clock = 0;
+
+static struct GeometryCache* geometry_find(int src_w, int src_h, int src_p) {
+	for (int i=0; i<GEOMETRY_CACHE_SIZE; i++) {
+		struct GeometryCache* entry = &geometry_cache[i];
+		if (entry->used && entry->src_w==src_w && entry->src_h==src_h && entry->src_p==src_p
+			&& entry->scaling==screen_scaling && entry->device_w==DEVICE_WIDTH && entry->device_h==DEVICE_HEIGHT
+			&& entry->aspect_ratio==core.aspect_ratio) return entry;
+	}
+	return NULL;
+}
+static void geometry_store(GFX_Renderer* r, int src_w, int src_h, int src_p, char* scaler_name) {
+	struct GeometryCache* entry = &geometry_cache[0];
+	for (int i=1; i<GEOMETRY_CACHE_SIZE; i++) {
+		if (geometry_cache[i].used<entry->used) entry = &geometry_cache[i];
+	}
+	
+	entry->src_w = src_w;
+	entry->src_h = src_h;
+	entry->src_p = src_p;
+	entry->scaling = screen_scaling;
+	entry->device_w = DEVICE_WIDTH;
+	entry->device_h = DEVICE_HEIGHT;
+	entry->aspect_ratio = core.aspect_ratio;
+	entry->renderer = *r;
+	strcpy(entry->scaler_name, scaler_name);
+	entry->used = ++geometry_clock;
+}
+static void geometry_restore(GFX_Renderer* r, struct GeometryCache* entry, char* scaler_name) {
+	// only the geometry, src/dst/blit belong to the live renderer
+	void* src = r->src;
+	void* dst = r->dst;
+	void* blit = r->blit;
+	*r = entry->renderer;
+	r->src = src;
+	r->dst = dst;
+	r->blit = blit;
+	
+	strcpy(scaler_name, entry->scaler_name);
+	entry->used = ++geometry_clock;
+}
 
+static void selectScaler(int src_w, int src_h, int src_p) {
+	LOG_info("selectScaler\n");
+	
+	if (downsample) buffer_realloc(src_w,src_h,src_p);
+	
+	char scaler_name[16];
+	struct GeometryCache* cached = geometry_find(src_w,src_h,src_p);
+	if (cached) geometry_restore(&renderer, cached, scaler_name);
+	else {
+		selectScalerGeometry(&renderer, src_w,src_h,src_p, scaler_name);
+		geometry_store(&renderer, src_w,src_h,src_p, scaler_name);
+	}
+	LOG_info("selectScaler: %s scale:%i aspect:%0.3f src:%i,%i %ix%i (%i) dst:%i,%i %ix%i (%i)\n",
+		scaler_name, renderer.scale, renderer.aspect,
+		renderer.src_x,renderer.src_y,renderer.src_w,renderer.src_h,renderer.src_p,
+		renderer.dst_x,renderer.dst_y,renderer.dst_w,renderer.dst_h,renderer.dst_p
+	);
+	
+	renderer.blit = GFX_getScaler(&renderer);
+	
+	int dst_w = renderer.dst_w;
+	int dst_h = renderer.dst_h;
+	int dst_p = renderer.dst_p;
 	if (fit) {
 		dst_w = DEVICE_WIDTH;
 		dst_h = DEVICE_HEIGHT;
@@ -2770,6 +2862,7 @@ static void selectScaler(int src_w, int src_h, int src_p) {
 		screen = GFX_resize(dst_w,dst_h,dst_p);
 	// }
 }
+static double blit_ms = 0; // smoothed GFX_blitRenderer time
 static void video_refresh_callback_main(const void *data, unsigned width, unsigned height, size_t pitch) {
 	// return;
 	
@@ -2823,10 +2916,10 @@ static void video_refresh_callback_main(const void *data, unsigned width, unsign
 		sprintf(debug_text, "%i,%i %ix%i", renderer.dst_x,renderer.dst_y, renderer.src_w*scale,renderer.src_h*scale);
 		blitBitmapText(debug_text,-x,y,(uint16_t*)data,pitch/2, width,height);
 	
-		sprintf(debug_text, "%.01f/%.01f %i%%", fps_double, cpu_double, (int)use_double);
+		sprintf(debug_text, "%.01f/%.01f %i%% (%.1f %i)", fps_double, cpu_double, (int)use_double, GFX_getFrameError(), GFX_getMissedFrames()); // pacing error in ms, missed vblanks
 		blitBitmapText(debug_text,x,-y,(uint16_t*)data,pitch/2, width,height);
 	
-		sprintf(debug_text, "%ix%i", renderer.dst_w,renderer.dst_h);
+		sprintf(debug_text, "%ix%i %.2fms (%.1f)", renderer.dst_w,renderer.dst_h, blit_ms, GFX_getLatency()); // frame start to present in ms
 		blitBitmapText(debug_text,-x,-y,(uint16_t*)data,pitch/2, width,height);
 	}
 	
@@ -2840,9 +2933,16 @@ static void video_refresh_callback_main(const void *data, unsigned width, unsign
 	renderer.dst = screen->pixels;
 	// LOG_info("video_refresh_callback: %ix%i@%i %ix%i@%i\n",width,height,pitch,screen->w,screen->h,screen->pitch);
 	
+	// per scaler path cost, shown (a frame late) by the debug hud
+	uint64_t blit_start = show_debug ? getMicroseconds() : 0;
 	GFX_blitRenderer(&renderer);
+	if (show_debug) blit_ms = blit_ms * 0.9 + (getMicroseconds() - blit_start) / 1000.0 * 0.1;
 	
-	if (!thread_video) GFX_flip(screen);
+	if (!thread_video) {
+		GFX_flip(screen);
+		TRACE_mark("first flip");
+		TRACE_quit(); // only the first frame is traced
+	}
 	last_flip_time = SDL_GetTicks();
 }
 static void video_refresh_callback(const void *data, unsigned width, unsigned height, size_t pitch) {
@@ -3030,6 +3130,9 @@ enum {
 static struct {
 	SDL_Surface* bitmap;
 	SDL_Surface* overlay;
+	SDL_Surface* backing; // scaled bitmap behind the menu
+	SDL_Surface* preview; // scaled save state preview
+	int preview_slot; // slot currently in preview, -1 to reload
 	char* items[MENU_ITEM_COUNT];
 	char* disc_paths[9]; // up to 9 paths, Arc the Lad Collection is 7 discs
 	char minui_dir[256];
@@ -3044,6 +3147,9 @@ static struct {
 	int preview_exists;
 } menu = {
 	.bitmap = NULL,
+	.backing = NULL,
+	.preview = NULL,
+	.preview_slot = -1,
 	.disc = -1,
 	.total_discs = 0,
 	.save_exists = 0,
@@ -3108,6 +3214,13 @@ void Menu_init(void) {
 }
 void Menu_quit(void) {
 	SDL_FreeSurface(menu.overlay);
+	if (menu.backing) SDL_FreeSurface(menu.backing);
+	if (menu.preview) SDL_FreeSurface(menu.preview);
+}
+static SDL_Surface* Menu_surface(SDL_Surface* surface, int w, int h) {
+	if (surface && surface->w==w && surface->h==h) return surface;
+	if (surface) SDL_FreeSurface(surface);
+	return SDL_CreateRGBSurface(SDL_SWSURFACE,w,h,FIXED_DEPTH,RGBA_MASK_565);
 }
 void Menu_beforeSleep(void) {
 	// LOG_info("beforeSleep\n");
@@ -3178,7 +3291,7 @@ static int Menu_message(char* message, char** pairs) {
 		}
 		else GFX_sync();
 		
-		hdmimon();
+		if (hdmimon()) break;
 	}
 	GFX_setMode(MODE_MENU);
 	return MENU_CALLBACK_NOP; // TODO: this should probably be an arg
@@ -3347,7 +3460,7 @@ int OptionControls_bind(MenuList* list, int i) {
 			}
 		}
 		GFX_sync();
-		hdmimon();
+		if (hdmimon()) break;
 	}
 	return MENU_CALLBACK_NEXT_ITEM;
 }
@@ -3460,7 +3573,7 @@ static int OptionShortcuts_bind(MenuList* list, int i) {
 			}
 		}
 		GFX_sync();
-		hdmimon();
+		if (hdmimon()) break;
 	}
 	return MENU_CALLBACK_NEXT_ITEM;
 }
@@ -3609,6 +3722,7 @@ static int Menu_options(MenuList* list) {
 		if (await_input) {
 			defer_menu = true;
 			list->on_confirm(list, selected);
+			if (!show_menu) break; // hdmimon closed it from the binding loop
 			
 			selected += 1;
 			if (selected>=count) {
@@ -3696,6 +3810,7 @@ static int Menu_options(MenuList* list) {
 				if (item->values==button_labels) await_input = 1; // button binding
 				else result = list->on_confirm(list, selected); // list-specific action, eg. show item detail view or input binding
 			}
+			if (!show_menu) break; // hdmimon closed it from a nested menu
 			if (result==MENU_CALLBACK_EXIT) show_options = 0;
 			else {
 				if (result==MENU_CALLBACK_NEXT_ITEM) {
@@ -3960,7 +4075,7 @@ static int Menu_options(MenuList* list) {
 			dirty = 0;
 		}
 		else GFX_sync();
-		hdmimon();
+		if (hdmimon()) break;
 	}
 	
 	// GFX_clearAll();
@@ -3969,19 +4084,86 @@ static int Menu_options(MenuList* list) {
 	return 0;
 }
 
+// source offsets (and blend weights) for each dst column,
+// shared by both scalers and only grown, never shrunk
+static uint32_t* menu_cols = NULL;
+static int menu_cols_size = 0;
+static uint32_t* Menu_columns(int sw, int dw, int bilinear) {
+	if (dw>menu_cols_size) {
+		free(menu_cols);
+		menu_cols = malloc(dw * sizeof(uint32_t));
+		menu_cols_size = menu_cols ? dw : 0;
+		if (!menu_cols) return NULL;
+	}
+	uint32_t mx = (sw << 16) / dw;
+	uint32_t sx = bilinear && mx>0x10000 ? (mx-0x10000)/2 : 0; // sample from the center of the covered src pixels
+	for (int x=0; x<dw; x++, sx+=mx) {
+		uint32_t i = sx >> 16;
+		uint32_t w = (sx >> 11) & 0x1f;
+		if (i>=sw-1) { i = sw-1; w = 0; }
+		menu_cols[x] = bilinear ? (i << 5) | w : i;
+	}
+	return menu_cols;
+}
+
+static void Menu_scaleNearest(void* __restrict src, void* __restrict dst, uint32_t sw, uint32_t sh, uint32_t sp, uint32_t dw, uint32_t dh, uint32_t dp) {
+	uint32_t* cols = Menu_columns(sw,dw,0);
+	if (!cols) return;
+	
+	uint32_t my = (sh << 16) / dh;
+	uint32_t sy = 0;
+	int last = -1;
+	for (int y=0; y<dh; y++, sy+=my) {
+		uint16_t* d = (uint16_t*)((uint8_t*)dst + y * dp);
+		int r = sy >> 16;
+		if (r==last) {
+			memcpy(d, (uint8_t*)d - dp, dw * FIXED_BPP);
+			continue;
+		}
+		uint16_t* s = (uint16_t*)((uint8_t*)src + r * sp);
+		for (int x=0; x<dw; x++) d[x] = s[cols[x]];
+		last = r;
+	}
+}
+
+// lerps two RGB565 pixels with channels spread so they can't overflow into each other, w is 0-32
+#define MENU_SPREAD(c) (((c) | ((c) << 16)) & 0x07e0f81f)
+static inline uint32_t Menu_lerp(uint32_t a, uint32_t b, uint32_t w) {
+	return ((a * (32 - w) + b * w) >> 5) & 0x07e0f81f;
+}
+static void Menu_scaleBilinear(void* __restrict src, void* __restrict dst, uint32_t sw, uint32_t sh, uint32_t sp, uint32_t dw, uint32_t dh, uint32_t dp) {
+	uint32_t* cols = Menu_columns(sw,dw,1);
+	if (!cols) return;
+	
+	uint32_t my = (sh << 16) / dh;
+	uint32_t sy = my>0x10000 ? (my-0x10000)/2 : 0;
+	for (int y=0; y<dh; y++, sy+=my) {
+		uint32_t r = sy >> 16;
+		uint32_t wy = (sy >> 11) & 0x1f;
+		if (r>=sh-1) { r = sh-1; wy = 0; }
+		uint16_t* s0 = (uint16_t*)((uint8_t*)src + r * sp);
+		uint16_t* s1 = wy ? (uint16_t*)((uint8_t*)s0 + sp) : s0;
+		uint16_t* d = (uint16_t*)((uint8_t*)dst + y * dp);
+		for (int x=0; x<dw; x++) {
+			uint32_t i = cols[x] >> 5;
+			uint32_t wx = cols[x] & 0x1f;
+			uint32_t j = wx ? i+1 : i;
+			uint32_t top = Menu_lerp(MENU_SPREAD(s0[i]), MENU_SPREAD(s0[j]), wx);
+			uint32_t bot = Menu_lerp(MENU_SPREAD(s1[i]), MENU_SPREAD(s1[j]), wx);
+			uint32_t c = Menu_lerp(top, bot, wy);
+			d[x] = c | (c >> 16);
+		}
+	}
+}
+
 static void Menu_scale(SDL_Surface* src, SDL_Surface* dst) {
 	// LOG_info("Menu_scale src: %ix%i dst: %ix%i\n", src->w,src->h,dst->w,dst->h);
 	
-	uint16_t* s = src->pixels;
-	uint16_t* d = dst->pixels;
-	
 	int sw = src->w;
 	int sh = src->h;
-	int sp = src->pitch / FIXED_BPP;
 	
 	int dw = dst->w;
 	int dh = dst->h;
-	int dp = dst->pitch / FIXED_BPP;
 	
 	int rx = 0;
 	int ry = 0;
@@ -4071,38 +4253,24 @@ static void Menu_scale(SDL_Surface* src, SDL_Surface* dst) {
 	// LOG_info("Menu_scale (r): %i,%i %ix%i\n",rx,ry,rw,rh);
 	// LOG_info("offset: %i,%i\n", renderer.src_x, renderer.src_y);
 
-	// dumb nearest neighbor scaling
-	int mx = (sw << 16) / rw;
-	int my = (sh << 16) / rh;
-	int ox = (renderer.src_x << 16);
-	int sx = ox;
-	int sy = (renderer.src_y << 16);
-	int lr = -1;
-	int sr = 0;
-	int dr = ry * dp;
-	int cp = dp * FIXED_BPP;
-	
-	// LOG_info("Menu_scale (s): %i,%i %ix%i\n",sx,sy,sw,sh);
-	// LOG_info("mx:%i my:%i sx>>16:%i sy>>16:%i\n",mx,my,((sx+mx) >> 16),((sy+my) >> 16));
-
-	for (int dy=0; dy<rh; dy++) {
-		sx = ox;
-		sr = (sy >> 16) * sp;
-		if (sr==lr) {
-			memcpy(d+dr,d+dr-dp,cp);
-		}
-		else {
-	        for (int dx=0; dx<rw; dx++) {
-	            d[dr + rx + dx] = s[sr + (sx >> 16)];
-				sx += mx;
-	        }
-		}
-		lr = sr;
-		sy += my;
-		dr += dp;
-    }
+	if (rw<=0 || rh<=0 || sw<=0 || sh<=0) return;
 	
-	// LOG_info("successful\n");
+	void* src_px = (uint8_t*)src->pixels + (renderer.src_y * src->pitch) + (renderer.src_x * FIXED_BPP);
+	void* dst_px = (uint8_t*)dst->pixels + (ry * dst->pitch) + (rx * FIXED_BPP);
+	
+	int xmul = rw / sw;
+	int ymul = rh / sh;
+	if (xmul*sw==rw && ymul*sh==rh && xmul<=SCALER_MAX_MUL && ymul<=SCALER_MAX_MUL) {
+		// integer multiples can use the (vectorized) emulation scalers
+		scaler_t scaler = scaler_lookup(FIXED_DEPTH, EFFECT_NONE, xmul, ymul);
+		scaler(src_px,dst_px,sw,sh,src->pitch,rw,rh,dst->pitch);
+	}
+	else if (rw<sw || rh<sh) {
+		Menu_scaleBilinear(src_px,dst_px,sw,sh,src->pitch,rw,rh,dst->pitch);
+	}
+	else {
+		Menu_scaleNearest(src_px,dst_px,sw,sh,src->pitch,rw,rh,dst->pitch);
+	}
 }
 
 static void Menu_initState(void) {
@@ -4154,6 +4322,7 @@ static void Menu_saveState(void) {
 	state_slot = menu.slot;
 	putInt(menu.slot_path, menu.slot);
 	State_write();
+	menu.preview_slot = -1;
 }
 static void Menu_loadState(void) {
 	// LOG_info("Menu_loadState\n");
@@ -4181,7 +4350,11 @@ static void Menu_loadState(void) {
 	}
 }
 
-static char* getAlias(char* path, char* alias) {
+static struct Aliases {
+	char path[256];
+	Hash* map;
+} aliases; // kept between menu opens, usually the same map.txt every time
+static void getAlias(char* path, char* alias) {
 	// LOG_info("alias path: %s\n", path);
 	char* tmp;
 	char map_path[256];
@@ -4196,36 +4369,28 @@ static char* getAlias(char* path, char* alias) {
 	if (file_name) file_name += 1;
 	// LOG_info("file_name: %s\n", file_name);
 	
-	if (exists(map_path)) {
-		FILE* file = fopen(map_path, "r");
-		if (file) {
-			char line[256];
-			while (fgets(line,256,file)!=NULL) {
-				normalizeNewline(line);
-				trimTrailingNewlines(line);
-				if (strlen(line)==0) continue; // skip empty lines
-			
-				tmp = strchr(line,'\t');
-				if (tmp) {
-					tmp[0] = '\0';
-					char* key = line;
-					char* value = tmp+1;
-					if (exactMatch(file_name,key)) {
-						strcpy(alias, value);
-						break;
-					}
-				}
-			}
-			fclose(file);
-		}
+	if (!exactMatch(aliases.path, map_path)) {
+		if (aliases.map) Hash_free(aliases.map);
+		aliases.map = Hash_load(map_path);
+		strcpy(aliases.path, map_path);
 	}
+	if (!aliases.map || !file_name) return;
+	
+	char* value = Hash_get(aliases.map, file_name);
+	if (value) strcpy(alias, value);
 }
 
 static void Menu_loop(void) {
 	menu.bitmap = SDL_CreateRGBSurfaceFrom(renderer.src, renderer.true_w, renderer.true_h, FIXED_DEPTH, renderer.src_p, RGBA_MASK_565);
 	// LOG_info("Menu_loop:menu.bitmap %ix%i\n", menu.bitmap->w,menu.bitmap->h);
 	
-	SDL_Surface* backing = SDL_CreateRGBSurface(SDL_SWSURFACE,DEVICE_WIDTH,DEVICE_HEIGHT,FIXED_DEPTH,RGBA_MASK_565); 
+	// only reallocated when the device size changes (eg. hdmi)
+	menu.backing = Menu_surface(menu.backing, DEVICE_WIDTH,DEVICE_HEIGHT);
+	menu.preview = Menu_surface(menu.preview, DEVICE_WIDTH/2,DEVICE_HEIGHT/2);
+	menu.preview_slot = -1;
+	SDL_Surface* backing = menu.backing;
+	SDL_Surface* preview = menu.preview;
+	SDL_FillRect(backing, NULL, 0);
 	Menu_scale(menu.bitmap, backing);
 	
 	int restore_w = screen->w;
@@ -4278,8 +4443,6 @@ static void Menu_loop(void) {
 	int ignore_menu = 0;
 	int menu_start = 0;
 	
-	SDL_Surface* preview = SDL_CreateRGBSurface(SDL_SWSURFACE,DEVICE_WIDTH/2,DEVICE_HEIGHT/2,FIXED_DEPTH,RGBA_MASK_565); // TODO: retain until changed?
-	
 	while (show_menu) {
 		GFX_startFrame();
 		uint32_t now = SDL_GetTicks();
@@ -4366,6 +4529,7 @@ static void Menu_loop(void) {
 					else {
 						int old_scaling = screen_scaling;
 						Menu_options(&options_menu);
+						if (!show_menu) break; // hdmimon closed it, backing is sized for the old output
 						if (screen_scaling!=old_scaling) {
 							selectScaler(renderer.true_w,renderer.true_h,renderer.src_p);
 						
@@ -4376,6 +4540,7 @@ static void Menu_loop(void) {
 						
 							SDL_FillRect(backing, NULL, 0);
 							Menu_scale(menu.bitmap, backing);
+							menu.preview_slot = -1;
 						}
 						dirty = 1;
 					}
@@ -4501,17 +4666,22 @@ static void Menu_loop(void) {
 				oy += SCALE1(WINDOW_RADIUS);
 				
 				if (menu.preview_exists) { // has save, has preview
-					// lotta memory churn here
-					SDL_Surface* bmp = IMG_Load(menu.bmp_path);
-					SDL_Surface* raw_preview = SDL_ConvertSurface(bmp, screen->format, SDL_SWSURFACE);
-					
-					// LOG_info("raw_preview %ix%i\n", raw_preview->w,raw_preview->h);
-					
-					SDL_FillRect(preview, NULL, 0);
-					Menu_scale(raw_preview, preview);
+					// only decoded and scaled when the slot changes
+					if (menu.preview_slot!=menu.slot) {
+						SDL_FillRect(preview, NULL, 0);
+						SDL_Surface* bmp = IMG_Load(menu.bmp_path);
+						if (bmp) {
+							SDL_Surface* raw_preview = SDL_ConvertSurface(bmp, screen->format, SDL_SWSURFACE);
+							// LOG_info("raw_preview %ix%i\n", raw_preview->w,raw_preview->h);
+							if (raw_preview) {
+								Menu_scale(raw_preview, preview);
+								SDL_FreeSurface(raw_preview);
+							}
+							SDL_FreeSurface(bmp);
+						}
+						menu.preview_slot = menu.slot;
+					}
 					SDL_BlitSurface(preview, NULL, screen, &(SDL_Rect){ox,oy});
-					SDL_FreeSurface(raw_preview);
-					SDL_FreeSurface(bmp);
 				}
 				else {
 					SDL_Rect preview_rect = {ox,oy,hw,hh};
@@ -4536,8 +4706,6 @@ static void Menu_loop(void) {
 		hdmimon();
 	}
 	
-	SDL_FreeSurface(preview);
-	
 	PAD_reset();
 
 	GFX_clearAll();
@@ -4567,7 +4735,6 @@ static void Menu_loop(void) {
 	
 	SDL_FreeSurface(menu.bitmap);
 	menu.bitmap = NULL;
-	SDL_FreeSurface(backing);
 	PWR_disableAutosleep();
 }
 
@@ -4665,9 +4832,167 @@ static void* coreThread(void *arg) {
 	pthread_exit(NULL);
 }
 
+#ifdef HAS_SCALER_HARNESS
+// minarch --golden <dir> [record]
+// feeds a synthetic frame at common core resolutions in every scaling
+// mode through video_refresh_callback_main(), so selectScaler() (twice,
+// the second time from its geometry cache), GFX_blitRenderer() and
+// GFX_flip() all run as they would in game, reads back what reached the
+// panel and compares it with <dir>/<size>-<mode>.png, a missing golden
+// is a failure unless record is passed (which (re)writes all of them),
+// the geometry and best frame time of each path go to <dir>/results.txt
+static struct {
+	int w;
+	int h;
+	double aspect_ratio;
+} golden_sizes[] = {
+	{160,144, 10.0/9}, // gb
+	{240,160,  3.0/2}, // gba
+	{256,224,  4.0/3}, // snes
+	{320,240,  4.0/3}, // ps
+	{512,448,  4.0/3}, // snes hi-res
+	{640,480,  4.0/3}, // ps hi-res
+	{0},
+};
+static char* golden_modes[] = { // in SCALE_ order
+	"native",
+	"aspect",
+	"fullscreen",
+	"cropped",
+};
+#define GOLDEN_RUNS 20
+
+static void Golden_fill(uint16_t* px, int w, int h, int p) {
+	// gradients to catch misplaced rows and columns, a checkerboard to
+	// catch doubled or dropped ones and a border to catch clipped edges
+	for (int y=0; y<h; y++) {
+		uint16_t* row = (uint16_t*)((uint8_t*)px + y * p);
+		for (int x=0; x<w; x++) {
+			uint16_t c = ((x * 31 / w) << 11) | ((y * 63 / h) << 5) | (((x ^ y) & 1) ? 0x1f : 0);
+			if (x==0 || y==0 || x==w-1 || y==h-1) c = 0xffff;
+			row[x] = c;
+		}
+	}
+}
+static int Golden_compare(SDL_Surface* surface, char* path) {
+	SDL_Surface* loaded = IMG_Load(path);
+	if (!loaded) return -1;
+	SDL_Surface* golden = SDL_ConvertSurface(loaded, surface->format, 0);
+	SDL_FreeSurface(loaded);
+	if (!golden) return -1;
+	
+	int differs = 0;
+	if (golden->w!=surface->w || golden->h!=surface->h) differs = surface->w * surface->h;
+	else {
+		for (int y=0; y<surface->h; y++) {
+			uint16_t* a = (uint16_t*)((uint8_t*)surface->pixels + y * surface->pitch);
+			uint16_t* b = (uint16_t*)((uint8_t*)golden->pixels + y * golden->pitch);
+			for (int x=0; x<surface->w; x++) {
+				if (a[x]!=b[x]) differs += 1;
+			}
+		}
+	}
+	SDL_FreeSurface(golden);
+	return differs;
+}
+static char* Golden_check(uint16_t* frame, int src_w, int src_h, int src_p, char* path, int record) {
+	// a zeroed dst_p is how changing the scaling option asks for a new scaler
+	renderer.dst_p = 0;
+	SDL_Surface* capture = GFX_captureFlip();
+	if (!capture) return "no capture";
+	video_refresh_callback_main(frame, src_w,src_h,src_p);
+	
+	char* status = "ok";
+	if (record) {
+		IMG_SavePNG(capture, path);
+		status = "recorded";
+	}
+	else {
+		int differs = Golden_compare(capture, path);
+		if (differs<0) status = "missing";
+		else if (differs) status = "differs";
+	}
+	SDL_FreeSurface(capture);
+	return status;
+}
+static int Golden_run(char* dir, int record) {
+	char results_path[MAX_PATH];
+	sprintf(results_path, "%s/results.txt", dir);
+	FILE* results = fopen(results_path, "a");
+	if (!results) {
+		LOG_error("Golden_run: unable to open %s\n", results_path);
+		return 1;
+	}
+	fprintf(results, "# %s %ix%i (%i) %s\n", PLATFORM, DEVICE_WIDTH,DEVICE_HEIGHT,DEVICE_PITCH, BUILD_HASH);
+	
+	// nearest neighbor and no pacing, the goldens are about geometry and
+	// the scaler path, not the gpu's filtering or the core's clock
+	GFX_setSharpness(SHARPNESS_SHARP);
+	GFX_setEffect(EFFECT_NONE);
+	GFX_setTargetFPS(-1);
+	
+	int failed = 0;
+	for (int i=0; golden_sizes[i].w; i++) {
+		int src_w = golden_sizes[i].w;
+		int src_h = golden_sizes[i].h;
+		int src_p = src_w * FIXED_BPP;
+		uint16_t* frame = malloc(src_p * src_h);
+		Golden_fill(frame, src_w,src_h,src_p);
+		core.aspect_ratio = golden_sizes[i].aspect_ratio;
+		
+		for (int mode=SCALE_NATIVE; mode<=SCALE_CROPPED; mode++) {
+			screen_scaling = mode;
+			
+			char golden_path[MAX_PATH];
+			sprintf(golden_path, "%s/%ix%i-%s.png", dir, src_w,src_h, golden_modes[mode]);
+			char* status = Golden_check(frame, src_w,src_h,src_p, golden_path, record);
+			// the second time the geometry comes from the cache and has to match too
+			char* cached = Golden_check(frame, src_w,src_h,src_p, golden_path, 0);
+			if (!exactMatch(cached, "ok")) status = cached;
+			if (!exactMatch(status, "ok") && !exactMatch(status, "recorded")) failed += 1;
+			
+			uint64_t best = UINT64_MAX;
+			for (int run=0; run<GOLDEN_RUNS; run++) {
+				uint64_t start = getMicroseconds();
+				video_refresh_callback_main(frame, src_w,src_h,src_p);
+				uint64_t elapsed = getMicroseconds() - start;
+				if (elapsed<best) best = elapsed;
+			}
+			
+			struct GeometryCache* geometry = geometry_find(src_w,src_h,src_p);
+			char* scaler_name = geometry ? geometry->scaler_name : "?";
+			GFX_Renderer* r = &renderer;
+			fprintf(results, "%ix%i\t%s\t%s\tscale:%i\tsrc:%i,%i %ix%i\tdst:%i,%i %ix%i (%i)\t%ius\t%s\n",
+				src_w,src_h, golden_modes[mode], scaler_name, r->scale,
+				r->src_x,r->src_y,r->src_w,r->src_h,
+				r->dst_x,r->dst_y,r->dst_w,r->dst_h,r->dst_p,
+				(int)best, status
+			);
+			LOG_info("Golden_run: %ix%i %s %s %ius %s\n", src_w,src_h, golden_modes[mode], scaler_name, (int)best, status);
+		}
+		free(frame);
+	}
+	fclose(results);
+	return failed;
+}
+#endif
+
 int main(int argc , char* argv[]) {
+	TRACE_init("minarch");
 	LOG_info("MinArch\n");
 
+#ifdef HAS_SCALER_HARNESS
+	if (argc>1 && exactMatch(argv[1], "--golden")) {
+		screen = GFX_init(MODE_MENU);
+		DEVICE_WIDTH = screen->w;
+		DEVICE_HEIGHT = screen->h;
+		DEVICE_PITCH = screen->pitch;
+		int failed = Golden_run(argc>2 ? argv[2] : ".", argc>3 && exactMatch(argv[3], "record"));
+		GFX_quit();
+		return failed ? EXIT_FAILURE : EXIT_SUCCESS;
+	}
+#endif
+
 	setOverclock(overclock); // default to normal
 	// force a stack overflow to ensure asan is linked and actually working
 	// char tmp[2];
@@ -4685,6 +5010,7 @@ int main(int argc , char* argv[]) {
 
 	screen = GFX_init(MODE_MENU);
 	PAD_init();
+	TRACE_mark("PAD_init");
 	DEVICE_WIDTH = screen->w;
 	DEVICE_HEIGHT = screen->h;
 	DEVICE_PITCH = screen->pitch;
@@ -4694,11 +5020,14 @@ int main(int argc , char* argv[]) {
 	PWR_init();
 	if (!HAS_POWER_BUTTON) PWR_disableSleep();
 	MSG_init();
+	TRACE_mark("PWR_init");
 	
 	// Overrides_init();
 	
 	Core_open(core_path, tag_name);
+	TRACE_mark("Core_open");
 	Game_open(rom_path); // nes tries to load gamegenie setting before this returns ffs
+	TRACE_mark("Game_open");
 	if (!game.is_open) goto finish;
 	
 	simple_mode = exists(SIMPLE_MODE_PATH);
@@ -4709,8 +5038,10 @@ int main(int argc , char* argv[]) {
 	Config_readOptions(); // cores with boot logo option (eg. gb) need to load options early
 	setOverclock(overclock);
 	GFX_setVsync(prevent_tearing);
+	TRACE_mark("Config_load");
 	
 	Core_init();
+	TRACE_mark("Core_init");
 	
 	// TODO: find a better place to do this
 	// mixing static and loaded data is messy
@@ -4723,12 +5054,17 @@ int main(int argc , char* argv[]) {
 	Config_readOptions(); // but others load and report options later (eg. nes)
 	Config_readControls(); // restore controls (after the core has reported its defaults)
 	Config_free();
+	TRACE_mark("Core_load");
 		
 	SND_init(core.sample_rate, core.fps);
+	GFX_setTargetFPS(core.fps);
 	InitSettings(); // after we initialize audio
+	TRACE_mark("SND_init");
 	Menu_init();
+	TRACE_mark("Menu_init");
 	State_resume();
 	Menu_initState(); // make ready for state shortcuts
+	TRACE_mark("State_resume");
 	
 	if (thread_video) {
 		core_mx = (pthread_mutex_t)PTHREAD_MUTEX_INITIALIZER;
@@ -4763,6 +5099,8 @@ int main(int argc , char* argv[]) {
 			if (backbuffer) {
 				video_refresh_callback_main(backbuffer->pixels,backbuffer->w,backbuffer->h,backbuffer->pitch);
 				GFX_flip(screen);
+				TRACE_mark("first flip");
+				TRACE_quit();
 			}
 			core_rq = (pthread_cond_t)PTHREAD_COND_INITIALIZER;
 			pthread_mutex_unlock(&core_mx);
@@ -4806,6 +5144,7 @@ int main(int argc , char* argv[]) {
 	QuitSettings();
 	
 finish:
+	TRACE_quit(); // when it never got as far as a frame
 
 	Game_close();
 	Core_unload();
@@ -6,6 +6,10 @@
 #include <ctype.h>
 #include <unistd.h>
 #include <fcntl.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <sys/stat.h>
+#include <time.h>
 
 #include "defines.h"
 #include "api.h"
@@ -74,34 +78,6 @@ static void StringArray_free(Array* self) {
 
 ///////////////////////////////////////
 
-typedef struct Hash {
-	Array* keys;
-	Array* values;
-} Hash; // not really a hash
-
-static Hash* Hash_new(void) {
-	Hash* self = malloc(sizeof(Hash));
-	self->keys = Array_new();
-	self->values = Array_new();
-	return self;
-}
-static void Hash_free(Hash* self) {
-	StringArray_free(self->keys);
-	StringArray_free(self->values);
-	free(self);
-}
-static void Hash_set(Hash* self, char* key, char* value) {
-	Array_push(self->keys, strdup(key));
-	Array_push(self->values, strdup(value));
-}
-static char* Hash_get(Hash* self, char* key) {
-	int i = StringArray_indexOf(self->keys, key);
-	if (i==-1) return NULL;
-	return self->values->items[i];
-}
-
-///////////////////////////////////////
-
 enum EntryType {
 	ENTRY_DIR,
 	ENTRY_PAK,
@@ -111,6 +87,7 @@ typedef struct Entry {
 	char* path;
 	char* name;
 	char* unique;
+	char* key; // collation key, built by EntryArray_sort() on demand
 	int type;
 	int alpha; // index in parent Directory's alphas Array, which points to the index of an Entry in its entries Array :sweat_smile:
 } Entry;
@@ -122,6 +99,7 @@ static Entry* Entry_new(char* path, int type) {
 	self->path = strdup(path);
 	self->name = strdup(display_name);
 	self->unique = NULL;
+	self->key = NULL;
 	self->type = type;
 	self->alpha = 0;
 	return self;
@@ -130,8 +108,17 @@ static void Entry_free(Entry* self) {
 	free(self->path);
 	free(self->name);
 	if (self->unique) free(self->unique);
+	if (self->key) free(self->key);
 	free(self);
 }
+static int Entry_setName(Entry* self, char* name) { // returns 1 if the name changed
+	if (exactMatch(self->name, name)) return 0;
+	free(self->name);
+	self->name = strdup(name);
+	if (self->key) free(self->key);
+	self->key = NULL;
+	return 1;
+}
 
 static int EntryArray_indexOf(Array* self, char* path) {
 	for (int i=0; i<self->count; i++) {
@@ -140,13 +127,72 @@ static int EntryArray_indexOf(Array* self, char* path) {
 	}
 	return -1;
 }
-static int EntryArray_sortEntry(const void* a, const void* b) {
-	Entry* item1 = *(Entry**)a;
-	Entry* item2 = *(Entry**)b;
-	return strcasecmp(item1->name, item2->name);
+
+// lowercased with every run of digits replaced by '0', its length and
+// the digits sans leading zeros, so a plain strcmp() puts "Game 2"
+// before "Game 10" and digits still sort where strcasecmp() had them
+static char* getSortKey(char* name) {
+	char key[MAX_PATH * 3]; // worst case every other char is a lone digit
+	char* out = key;
+	char* end = key + sizeof(key) - 4;
+	while (*name && out<end) {
+		if (isdigit((unsigned char)*name)) {
+			while (name[0]=='0' && isdigit((unsigned char)name[1])) name += 1;
+			char* digits = name;
+			while (isdigit((unsigned char)*name)) name += 1;
+			int len = name - digits;
+			*out++ = '0';
+			*out++ = MIN(len, 255);
+			len = MIN(len, end - out);
+			memcpy(out, digits, len);
+			out += len;
+		}
+		else *out++ = tolower((unsigned char)*name++);
+	}
+	*out = '\0';
+	return strdup(key);
+}
+static int EntryArray_compare(Entry* a, Entry* b) {
+	int order = strcmp(a->key, b->key);
+	return order ? order : strcmp(a->name, b->name); // keeps identical names adjacent for Directory_index()
 }
+// bottom up merge sort, stable and linear when the runs are already in
+// order, eg. a listing that's been sorted before and had a few appended
 static void EntryArray_sort(Array* self) {
-	qsort(self->items, self->count, sizeof(void*), EntryArray_sortEntry);
+	int count = self->count;
+	if (count<2) return;
+	
+	for (int i=0; i<count; i++) {
+		Entry* entry = self->items[i];
+		if (!entry->key) entry->key = getSortKey(entry->name);
+	}
+	
+	void** src = self->items;
+	void** dst = malloc(sizeof(void*) * count);
+	for (int width=1; width<count; width*=2) {
+		for (int lo=0; lo<count; lo+=width*2) {
+			int mid = MIN(lo+width, count);
+			int hi = MIN(lo+width*2, count);
+			if (mid==hi || EntryArray_compare(src[mid-1], src[mid])<=0) {
+				memcpy(dst+lo, src+lo, sizeof(void*) * (hi-lo));
+				continue;
+			}
+			int i = lo;
+			int j = mid;
+			int k = lo;
+			while (i<mid && j<hi) dst[k++] = EntryArray_compare(src[j], src[i])<0 ? src[j++] : src[i++];
+			while (i<mid) dst[k++] = src[i++];
+			while (j<hi) dst[k++] = src[j++];
+		}
+		void** tmp = src;
+		src = dst;
+		dst = tmp;
+	}
+	if (src!=self->items) {
+		memcpy(self->items, src, sizeof(void*) * count);
+		dst = src;
+	}
+	free(dst);
 }
 
 static void EntryArray_free(Array* self) {
@@ -183,6 +229,7 @@ typedef struct Directory {
 	char* name;
 	Array* entries;
 	IntArray* alphas;
+	struct Loader* loader; // NULL once fully loaded
 	// rendering
 	int selected;
 	int start;
@@ -211,79 +258,48 @@ static void getUniqueName(Entry* entry, char* out_name) {
 	strcpy(tmp, ")");
 }
 
-static void Directory_index(Directory* self) {
+static void Directory_index(Directory* self, int sort) { // sort is for listings that aren't sorted yet
 	int is_collection = prefixMatch(COLLECTIONS_PATH, self->path);
 	int skip_index = exactMatch(FAUX_RECENT_PATH, self->path) || is_collection; // not alphabetized
 	
-	Hash* map = NULL;
 	char map_path[256];
 	sprintf(map_path, "%s/map.txt", is_collection ? COLLECTIONS_PATH : self->path);
-	if (exists(map_path)) {
-		FILE* file = fopen(map_path, "r");
-		if (file) {
-			map = Hash_new();
-			char line[256];
-			while (fgets(line,256,file)!=NULL) {
-				normalizeNewline(line);
-				trimTrailingNewlines(line);
-				if (strlen(line)==0) continue; // skip empty lines
-
-				char* tmp = strchr(line,'\t');
-				if (tmp) {
-					tmp[0] = '\0';
-					char* key = line;
-					char* value = tmp+1;
-					Hash_set(map, key, value);
-				}
+	Hash* map = Hash_load(map_path);
+	if (map) {
+		int filter = 0;
+		for (int i=0; i<self->entries->count; i++) {
+			Entry* entry = self->entries->items[i];
+			char* filename = strrchr(entry->path, '/')+1;
+			char* alias = Hash_get(map, filename);
+			if (alias && Entry_setName(entry, alias)) {
+				sort = 1;
+				if (!filter && hide(entry->name)) filter = 1;
 			}
-			fclose(file);
-			
-			int resort = 0;
-			int filter = 0;
+		}
+		
+		if (filter) {
+			Array* entries = Array_new();
 			for (int i=0; i<self->entries->count; i++) {
 				Entry* entry = self->entries->items[i];
-				char* filename = strrchr(entry->path, '/')+1;
-				char* alias = Hash_get(map, filename);
-				if (alias) {
-					free(entry->name);
-					entry->name = strdup(alias);
-					resort = 1;
-					if (!filter && hide(entry->name)) filter = 1;
+				if (hide(entry->name)) {
+					Entry_free(entry);
 				}
-			}
-			
-			if (filter) {
-				Array* entries = Array_new();
-				for (int i=0; i<self->entries->count; i++) {
-					Entry* entry = self->entries->items[i];
-					if (hide(entry->name)) {
-						Entry_free(entry);
-					}
-					else {
-						Array_push(entries, entry);
-					}
+				else {
+					Array_push(entries, entry);
 				}
-				Array_free(self->entries); // not EntryArray_free because we've just moved the entries from the original to the filtered one!
-				self->entries = entries;
 			}
-			if (resort) EntryArray_sort(self->entries);
+			Array_free(self->entries); // not EntryArray_free because we've just moved the entries from the original to the filtered one!
+			self->entries = entries;
 		}
+		Hash_free(map);
 	}
+	if (sort) EntryArray_sort(self->entries);
 	
 	Entry* prior = NULL;
 	int alpha = -1;
 	int index = 0;
 	for (int i=0; i<self->entries->count; i++) {
 		Entry* entry = self->entries->items[i];
-		if (map) {
-			char* filename = strrchr(entry->path, '/')+1;
-			char* alias = Hash_get(map, filename);
-			if (alias) {
-				free(entry->name);
-				entry->name = strdup(alias);
-			}
-		}
-		
 		if (prior!=NULL && exactMatch(prior->name, entry->name)) {
 			if (prior->unique) free(prior->unique);
 			if (entry->unique) free(entry->unique);
@@ -317,8 +333,6 @@ static void Directory_index(Directory* self) {
 		
 		prior = entry;
 	}
-	
-	if (map) Hash_free(map);
 }
 
 static Array* getRoot(void);
@@ -326,6 +340,13 @@ static Array* getRecents(void);
 static Array* getCollection(char* path);
 static Array* getDiscs(char* path);
 static Array* getEntries(char* path);
+static int Index_restore(Directory* self);
+static void Index_build(Directory* self);
+static Array* Search_current(void);
+static void Directory_load(Directory* self);
+static void Directory_cancel(Directory* self);
+static void Directory_wait(Directory* self);
+static int Directory_update(Directory* self);
 
 static Directory* Directory_new(char* path, int selected) {
 	char display_name[256];
@@ -334,12 +355,19 @@ static Directory* Directory_new(char* path, int selected) {
 	Directory* self = malloc(sizeof(Directory));
 	self->path = strdup(path);
 	self->name = strdup(display_name);
+	self->alphas = IntArray_new();
+	self->loader = NULL;
+	self->selected = selected;
 	if (exactMatch(path, SDCARD_PATH)) {
 		self->entries = getRoot();
 	}
 	else if (exactMatch(path, FAUX_RECENT_PATH)) {
 		self->entries = getRecents();
 	}
+	else if (exactMatch(path, FAUX_SEARCH_PATH)) {
+		self->entries = Search_current();
+		return self; // ranked, not alphabetized
+	}
 	else if (!exactMatch(path, COLLECTIONS_PATH) && prefixMatch(COLLECTIONS_PATH, path) && suffixMatch(".txt", path)) {
 		self->entries = getCollection(path);
 	}
@@ -347,14 +375,14 @@ static Directory* Directory_new(char* path, int selected) {
 		self->entries = getDiscs(path);
 	}
 	else {
-		self->entries = getEntries(path);
+		if (!Index_restore(self)) Directory_load(self);
+		return self;
 	}
-	self->alphas = IntArray_new();
-	self->selected = selected;
-	Directory_index(self);
+	Directory_index(self, 0);
 	return self;
 }
 static void Directory_free(Directory* self) {
+	Directory_cancel(self);
 	free(self->path);
 	free(self->name);
 	EntryArray_free(self->entries);
@@ -377,7 +405,7 @@ static void DirectoryArray_free(Array* self) {
 typedef struct Recent {
 	char* path; // NOTE: this is without the SDCARD_PATH prefix!
 	char* alias;
-	int available;
+	int available; // -1 until Recent_isAvailable() looks for its emu
 } Recent;
  // yiiikes
 static char* recent_alias = NULL;
@@ -385,18 +413,22 @@ static char* recent_alias = NULL;
 static int hasEmu(char* emu_name);
 static Recent* Recent_new(char* path, char* alias) {
 	Recent* self = malloc(sizeof(Recent));
-
-	char sd_path[256]; // only need to get emu name
-	sprintf(sd_path, "%s%s", SDCARD_PATH, path);
-
-	char emu_name[256];
-	getEmuName(sd_path, emu_name);
-	
 	self->path = strdup(path);
 	self->alias = alias ? strdup(alias) : NULL;
-	self->available = hasEmu(emu_name);
+	self->available = -1;
 	return self;
 }
+static int Recent_isAvailable(Recent* self) {
+	if (self->available==-1) {
+		char sd_path[256]; // only need to get emu name
+		sprintf(sd_path, "%s%s", SDCARD_PATH, self->path);
+		
+		char emu_name[256];
+		getEmuName(sd_path, emu_name);
+		self->available = hasEmu(emu_name);
+	}
+	return self->available;
+}
 static void Recent_free(Recent* self) {
 	free(self->path);
 	if (self->alias) free(self->alias);
@@ -438,19 +470,22 @@ static int restore_end = 0;
 ///////////////////////////////////////
 
 #define MAX_RECENTS 24 // a multiple of all menu rows
+static char recents_saved[MAX_RECENTS * 514]; // what's in RECENT_PATH, a path and alias per line
 static void saveRecents(void) {
+	char data[sizeof(recents_saved)];
+	char* tmp = data;
+	data[0] = '\0';
+	for (int i=0; i<recents->count; i++) {
+		Recent* recent = recents->items[i];
+		tmp += sprintf(tmp, "%s%s%s\n", recent->path, recent->alias ? "\t" : "", recent->alias ? recent->alias : "");
+	}
+	if (exactMatch(data, recents_saved)) return; // don't rewrite the sd card for nothing
+	
 	FILE* file = fopen(RECENT_PATH, "w");
 	if (file) {
-		for (int i=0; i<recents->count; i++) {
-			Recent* recent = recents->items[i];
-			fputs(recent->path, file);
-			if (recent->alias) {
-				fputs("\t", file);
-				fputs(recent->alias, file);
-			}
-			putc('\n', file);
-		}
+		fputs(data, file);
 		fclose(file);
+		strcpy(recents_saved, data);
 	}
 }
 static void addRecent(char* path, char* alias) {
@@ -485,7 +520,7 @@ static int hasCue(char* dir_path, char* cue_path) { // NOTE: dir_path not rom_pa
 	sprintf(cue_path, "%s/%s.cue", dir_path, tmp);
 	return exists(cue_path);
 }
-static int hasM3u(char* rom_path, char* m3u_path) { // NOTE: rom_path not dir_path
+static void getM3uPath(char* rom_path, char* m3u_path) { // NOTE: rom_path not dir_path
 	char* tmp;
 	
 	strcpy(m3u_path, rom_path);
@@ -511,10 +546,46 @@ static int hasM3u(char* rom_path, char* m3u_path) { // NOTE: rom_path not dir_pa
 	// add extension
 	tmp = m3u_path + strlen(m3u_path);
 	strcpy(tmp, ".m3u");
-	
+}
+static int hasM3u(char* rom_path, char* m3u_path) { // NOTE: rom_path not dir_path
+	getM3uPath(rom_path, m3u_path);
 	return exists(m3u_path);
 }
 
+// recents mostly live in a handful of folders, checking them with
+// fstatat() against a dirfd per folder saves resolving every full path
+#define RECENT_DIRS 8
+typedef struct RecentDirs {
+	int count;
+	char paths[RECENT_DIRS][256];
+	int fds[RECENT_DIRS];
+} RecentDirs;
+
+static int RecentDirs_exists(RecentDirs* self, char* path) {
+	char* name = strrchr(path, '/');
+	int len = name ? name - path : 0;
+	if (!len || len>=256) return exists(path);
+	
+	int i = 0;
+	while (i<self->count && !(strncmp(self->paths[i], path, len)==0 && self->paths[i][len]=='\0')) i += 1;
+	if (i==self->count) {
+		if (self->count==RECENT_DIRS) return exists(path);
+		memcpy(self->paths[i], path, len);
+		self->paths[i][len] = '\0';
+		self->fds[i] = open(self->paths[i], O_RDONLY | O_DIRECTORY); // -1 remembers a missing folder too
+		self->count += 1;
+	}
+	
+	struct stat st;
+	return self->fds[i]!=-1 && fstatat(self->fds[i], name+1, &st, 0)==0;
+}
+static void RecentDirs_close(RecentDirs* self) {
+	for (int i=0; i<self->count; i++) {
+		if (self->fds[i]!=-1) close(self->fds[i]);
+	}
+	self->count = 0;
+}
+
 static int hasRecents(void) {
 	LOG_info("hasRecents %s\n", RECENT_PATH);
 	int has = 0;
@@ -526,7 +597,7 @@ static int hasRecents(void) {
 		if (exists(sd_path)) {
 			char* disc_path = sd_path + strlen(SDCARD_PATH); // makes path platform agnostic
 			Recent* recent = Recent_new(disc_path, NULL);
-			if (recent->available) has += 1;
+			has = has || Recent_isAvailable(recent);
 			Array_push(recents, recent);
 		
 			char parent_path[256];
@@ -538,10 +609,18 @@ static int hasRecents(void) {
 		unlink(CHANGE_DISC_PATH);
 	}
 	
+	RecentDirs dirs = {0};
+	int saved = 0;
 	FILE* file = fopen(RECENT_PATH, "r"); // newest at top
 	if (file) {
 		char line[256];
 		while (fgets(line,256,file)!=NULL) {
+			int len = strlen(line);
+			if (saved+len<sizeof(recents_saved)) {
+				memcpy(recents_saved+saved, line, len+1);
+				saved += len;
+			}
+			
 			normalizeNewline(line);
 			trimTrailingNewlines(line);
 			if (strlen(line)==0) continue; // skip empty lines
@@ -558,44 +637,44 @@ static int hasRecents(void) {
 			
 			char sd_path[256];
 			sprintf(sd_path, "%s%s", SDCARD_PATH, path);
-			if (exists(sd_path)) {
-				if (recents->count<MAX_RECENTS) {
-					// this logic replaces an existing disc from a multi-disc game with the last used
-					char m3u_path[256];
-					if (hasM3u(sd_path, m3u_path)) { // TODO: this might tank launch speed
-						char parent_path[256];
-						strcpy(parent_path, path);
-						char* tmp = strrchr(parent_path, '/') + 1;
-						tmp[0] = '\0';
-						
-						int found = 0;
-						for (int i=0; i<parent_paths->count; i++) {
-							char* path = parent_paths->items[i];
-							if (prefixMatch(path, parent_path)) {
-								found = 1;
-								break;
-							}
+			if (recents->count<MAX_RECENTS && RecentDirs_exists(&dirs, sd_path)) {
+				// this logic replaces an existing disc from a multi-disc game with the last used
+				char m3u_path[256];
+				getM3uPath(sd_path, m3u_path);
+				if (RecentDirs_exists(&dirs, m3u_path)) {
+					char parent_path[256];
+					strcpy(parent_path, path);
+					char* tmp = strrchr(parent_path, '/') + 1;
+					tmp[0] = '\0';
+					
+					int found = 0;
+					for (int i=0; i<parent_paths->count; i++) {
+						char* path = parent_paths->items[i];
+						if (prefixMatch(path, parent_path)) {
+							found = 1;
+							break;
 						}
-						if (found) continue;
-						
-						Array_push(parent_paths, strdup(parent_path));
 					}
+					if (found) continue;
 					
-					// LOG_info("path:%s alias:%s\n", path, alias);
-					
-					Recent* recent = Recent_new(path, alias);
-					if (recent->available) has += 1;
-					Array_push(recents, recent);
+					Array_push(parent_paths, strdup(parent_path));
 				}
+				
+				// LOG_info("path:%s alias:%s\n", path, alias);
+				
+				Recent* recent = Recent_new(path, alias);
+				has = has || Recent_isAvailable(recent); // the rest wait for getRecents()
+				Array_push(recents, recent);
 			}
 		}
 		fclose(file);
 	}
+	RecentDirs_close(&dirs);
 	
-	saveRecents();
+	saveRecents(); // only writes if a recent was dropped
 	
 	StringArray_free(parent_paths);
-	return has>0;
+	return has;
 }
 static int hasCollections(void) {
 	int has = 0;
@@ -636,11 +715,7 @@ static int hasRoms(char* dir_name) {
 	// if (!has) printf("No roms for %s!\n", dir_name);
 	return has;
 }
-static Array* getRoot(void) {
-	Array* root = Array_new();
-	
-	if (hasRecents()) Array_push(root, Entry_new(FAUX_RECENT_PATH, ENTRY_DIR));
-	
+static Array* getSystems(void) {
 	Array* entries = Array_new();
 	DIR* dh = opendir(ROMS_PATH);
 	if (dh!=NULL) {
@@ -678,46 +753,31 @@ static Array* getRoot(void) {
 	// we don't support hidden remaps here
 	char map_path[256];
 	sprintf(map_path, "%s/map.txt", ROMS_PATH);
-	if (entries->count>0 && exists(map_path)) {
-		FILE* file = fopen(map_path, "r");
-		if (file) {
-			Hash* map = Hash_new();
-			char line[256];
-			while (fgets(line,256,file)!=NULL) {
-				normalizeNewline(line);
-				trimTrailingNewlines(line);
-				if (strlen(line)==0) continue; // skip empty lines
-
-				char* tmp = strchr(line,'\t');
-				if (tmp) {
-					tmp[0] = '\0';
-					char* key = line;
-					char* value = tmp+1;
-					Hash_set(map, key, value);
-				}
-			}
-			fclose(file);
-			
-			int resort = 0;
-			for (int i=0; i<entries->count; i++) {
-				Entry* entry = entries->items[i];
-				char* filename = strrchr(entry->path, '/')+1;
-				char* alias = Hash_get(map, filename);
-				if (alias) {
-					free(entry->name);
-					entry->name = strdup(alias);
-					resort = 1;
-				}
-			} 
-			if (resort) EntryArray_sort(entries);
-			Hash_free(map);
-		}
+	Hash* map = entries->count>0 ? Hash_load(map_path) : NULL;
+	if (map) {
+		int resort = 0;
+		for (int i=0; i<entries->count; i++) {
+			Entry* entry = entries->items[i];
+			char* filename = strrchr(entry->path, '/')+1;
+			char* alias = Hash_get(map, filename);
+			if (alias && Entry_setName(entry, alias)) resort = 1;
+		} 
+		if (resort) EntryArray_sort(entries);
+		Hash_free(map);
 	}
+	return entries;
+}
+static Array* Index_getSystems(void);
+static Array* getRoot(void) {
+	Array* root = Array_new();
+	
+	if (hasRecents()) Array_push(root, Entry_new(FAUX_RECENT_PATH, ENTRY_DIR));
 	
+	Array* entries = Index_getSystems();
 	if (hasCollections()) {
 		if (entries->count) Array_push(root, Entry_new(COLLECTIONS_PATH, ENTRY_DIR));
 		else { // no visible systems, promote collections to root
-			dh = opendir(COLLECTIONS_PATH);
+			DIR* dh = opendir(COLLECTIONS_PATH);
 			if (dh!=NULL) {
 				struct dirent *dp;
 				char* tmp;
@@ -755,16 +815,13 @@ static Array* getRecents(void) {
 	Array* entries = Array_new();
 	for (int i=0; i<recents->count; i++) {
 		Recent* recent = recents->items[i];
-		if (!recent->available) continue;
+		if (!Recent_isAvailable(recent)) continue;
 		
 		char sd_path[256];
 		sprintf(sd_path, "%s%s", SDCARD_PATH, recent->path);
 		int type = suffixMatch(".pak", sd_path) ? ENTRY_PAK : ENTRY_ROM; // ???
 		Entry* entry = Entry_new(sd_path, type);
-		if (recent->alias) {
-			free(entry->name);
-			entry->name = strdup(recent->alias);
-		}
+		if (recent->alias) Entry_setName(entry, recent->alias);
 		Array_push(entries, entry);
 	}
 	return entries;
@@ -823,10 +880,9 @@ static Array* getDiscs(char* path){
 			if (exists(disc_path)) {
 				disc += 1;
 				Entry* entry = Entry_new(disc_path, ENTRY_ROM);
-				free(entry->name);
 				char name[16];
 				sprintf(name, "Disc %i", disc);
-				entry->name = strdup(name);
+				Entry_setName(entry, name);
 				Array_push(entries, entry);
 			}
 		}
@@ -860,6 +916,15 @@ static int getFirstDisc(char* m3u_path, char* disc_path) { // based on getDiscs(
 	return found;
 }
 
+static int getEntryType(char* full_path, struct dirent* dp) {
+	if (dp->d_type==DT_DIR) {
+		// TODO: this should make sure launch.sh exists
+		if (suffixMatch(".pak", dp->d_name)) return ENTRY_PAK;
+		return ENTRY_DIR;
+	}
+	if (prefixMatch(COLLECTIONS_PATH, full_path)) return ENTRY_DIR; // :shrug:
+	return ENTRY_ROM;
+}
 static void addEntries(Array* entries, char* path) {
 	DIR *dh = opendir(path);
 	if (dh!=NULL) {
@@ -871,26 +936,7 @@ static void addEntries(Array* entries, char* path) {
 		while((dp = readdir(dh)) != NULL) {
 			if (hide(dp->d_name)) continue;
 			strcpy(tmp, dp->d_name);
-			int is_dir = dp->d_type==DT_DIR;
-			int type;
-			if (is_dir) {
-				// TODO: this should make sure launch.sh exists
-				if (suffixMatch(".pak", dp->d_name)) {
-					type = ENTRY_PAK;
-				}
-				else {
-					type = ENTRY_DIR;
-				}
-			}
-			else {
-				if (prefixMatch(COLLECTIONS_PATH, full_path)) {
-					type = ENTRY_DIR; // :shrug:
-				}
-				else {
-					type = ENTRY_ROM;
-				}
-			}
-			Array_push(entries, Entry_new(full_path, type));
+			Array_push(entries, Entry_new(full_path, getEntryType(full_path, dp)));
 		}
 		closedir(dh);
 	}
@@ -906,8 +952,9 @@ static int isConsoleDir(char* path) {
 	return exactMatch(parent_dir, ROMS_PATH);
 }
 
-static Array* getEntries(char* path){
-	Array* entries = Array_new();
+// the folders whose contents make up path's listing
+static Array* getEntryDirs(char* path) {
+	Array* dirs = Array_new();
 
 	if (isConsoleDir(path)) { // top-level console folder, might collate
 		char collated_path[256];
@@ -930,19 +977,605 @@ static Array* getEntries(char* path){
 				strcpy(tmp, dp->d_name);
 			
 				if (!prefixMatch(collated_path, full_path)) continue;
-				addEntries(entries, full_path);
+				Array_push(dirs, strdup(full_path));
 			}
 			closedir(dh);
 		}
 	}
-	else addEntries(entries, path); // just a subfolder
+	else Array_push(dirs, strdup(path)); // just a subfolder
 	
-	EntryArray_sort(entries);
+	return dirs;
+}
+static Array* getEntries(char* path){
+	Array* entries = Array_new();
+	Array* dirs = getEntryDirs(path);
+	for (int i=0; i<dirs->count; i++) {
+		addEntries(entries, dirs->items[i]);
+	}
+	StringArray_free(dirs);
 	return entries;
 }
 
 ///////////////////////////////////////
 
+// library index, a snapshot of every listing minui builds (entries with
+// their display names, map.txt aliases and alpha buckets, and which
+// systems have an emu) so large libraries don't wait on the sd card's
+// readdir every launch. each listing remembers the mtimes of the paths
+// it was built from and is only used while those still match, stale ones
+// are rebuilt on open or ahead of time by a background thread
+
+#define INDEX_MAGIC 0x5844494d // MIDX
+#define INDEX_VERSION 1
+#define INDEX_SLACK 2 // fat only stores mtimes to the nearest 2 seconds
+
+typedef struct IndexStamp {
+	char* path;
+	int64_t mtime; // -1 when missing
+} IndexStamp;
+
+typedef struct IndexDir {
+	char* path;
+	int64_t built;
+	int stamp_count;
+	IndexStamp* stamps;
+	Array* entries; // EntryArray
+	IntArray alphas;
+} IndexDir;
+
+static struct Index {
+	Array* dirs; // IndexDir
+	int dirty;
+	pthread_mutex_t lock;
+	pthread_t thread;
+	Array* warm; // paths for the thread to check
+} idx = {
+	.lock = PTHREAD_MUTEX_INITIALIZER,
+};
+
+static int64_t getMtime(char* path) {
+	struct stat st;
+	if (stat(path, &st)) return -1;
+	return st.st_mtime;
+}
+
+static Entry* Entry_copy(Entry* entry) {
+	Entry* self = malloc(sizeof(Entry));
+	self->path = strdup(entry->path);
+	self->name = strdup(entry->name);
+	self->unique = entry->unique ? strdup(entry->unique) : NULL;
+	self->key = entry->key ? strdup(entry->key) : NULL;
+	self->type = entry->type;
+	self->alpha = entry->alpha;
+	return self;
+}
+static Array* EntryArray_copy(Array* entries) {
+	Array* self = Array_new();
+	for (int i=0; i<entries->count; i++) {
+		Array_push(self, Entry_copy(entries->items[i]));
+	}
+	return self;
+}
+
+static IndexDir* IndexDir_new(char* path) {
+	IndexDir* self = calloc(1, sizeof(IndexDir));
+	self->path = strdup(path);
+	self->built = time(NULL);
+	return self;
+}
+static void IndexDir_addStamp(IndexDir* self, char* path, int64_t mtime) {
+	self->stamps = realloc(self->stamps, sizeof(IndexStamp) * (self->stamp_count + 1));
+	IndexStamp* stamp = &self->stamps[self->stamp_count++];
+	stamp->path = strdup(path);
+	stamp->mtime = mtime;
+}
+static void IndexDir_stamp(IndexDir* self, char* path) {
+	IndexDir_addStamp(self, path, getMtime(path));
+}
+static void IndexDir_free(IndexDir* self) {
+	for (int i=0; i<self->stamp_count; i++) {
+		free(self->stamps[i].path);
+	}
+	free(self->stamps);
+	if (self->entries) EntryArray_free(self->entries);
+	free(self->path);
+	free(self);
+}
+static int IndexDir_isFresh(IndexDir* self) {
+	for (int i=0; i<self->stamp_count; i++) {
+		IndexStamp* stamp = &self->stamps[i];
+		if (getMtime(stamp->path)!=stamp->mtime) return 0;
+		// changed too close to the build to tell if the build saw it, an
+		// mtime further off either way (eg. the clock is behind files
+		// copied from a pc) wasn't written during the build
+		int64_t since = stamp->mtime - self->built;
+		if (since>=-INDEX_SLACK && since<=INDEX_SLACK) return 0;
+	}
+	return 1;
+}
+
+// everything a listing of path depends on, taken before reading it so
+// a change made while reading leaves the listing stale instead of lost
+static IndexDir* IndexDir_stamped(char* path) {
+	IndexDir* self = IndexDir_new(path);
+	char sub_path[256];
+	
+	if (exactMatch(path, ROMS_PATH)) { // systems, see getSystems()
+		IndexDir_stamp(self, ROMS_PATH);
+		IndexDir_stamp(self, ROMS_PATH "/map.txt");
+		IndexDir_stamp(self, PAKS_PATH "/Emus");
+		IndexDir_stamp(self, SDCARD_PATH "/Emus/" PLATFORM);
+		
+		DIR* dh = opendir(ROMS_PATH);
+		if (dh!=NULL) {
+			struct dirent* dp;
+			while((dp = readdir(dh)) != NULL) {
+				if (hide(dp->d_name) || dp->d_type!=DT_DIR) continue;
+				sprintf(sub_path, "%s/%s", ROMS_PATH, dp->d_name);
+				IndexDir_stamp(self, sub_path); // hasRoms() only lists non-empty ones
+			}
+			closedir(dh);
+		}
+		return self;
+	}
+	
+	if (isConsoleDir(path)) IndexDir_stamp(self, ROMS_PATH); // collated folders coming or going
+	Array* dirs = getEntryDirs(path);
+	for (int i=0; i<dirs->count; i++) {
+		IndexDir_stamp(self, dirs->items[i]);
+	}
+	StringArray_free(dirs);
+	
+	sprintf(sub_path, "%s/map.txt", prefixMatch(COLLECTIONS_PATH, path) ? COLLECTIONS_PATH : path);
+	IndexDir_stamp(self, sub_path);
+	return self;
+}
+
+static IndexDir* Index_find(char* path) {
+	for (int i=0; i<idx.dirs->count; i++) {
+		IndexDir* dir = idx.dirs->items[i];
+		if (exactMatch(dir->path, path)) return dir;
+	}
+	return NULL;
+}
+static void Index_store(IndexDir* dir, Array* entries, IntArray* alphas) {
+	dir->entries = EntryArray_copy(entries);
+	if (alphas) dir->alphas = *alphas;
+	
+	pthread_mutex_lock(&idx.lock);
+	IndexDir* old = Index_find(dir->path);
+	if (old) {
+		int i = 0;
+		while (idx.dirs->items[i]!=old) i += 1;
+		idx.dirs->items[i] = dir;
+		IndexDir_free(old);
+	}
+	else Array_push(idx.dirs, dir);
+	idx.dirty = 1;
+	pthread_mutex_unlock(&idx.lock);
+}
+
+// fills in a Directory's entries and alphas when its listing is fresh
+static int Index_restore(Directory* self) {
+	int restored = 0;
+	pthread_mutex_lock(&idx.lock);
+	IndexDir* dir = Index_find(self->path);
+	if (dir && IndexDir_isFresh(dir)) {
+		self->entries = EntryArray_copy(dir->entries);
+		*self->alphas = dir->alphas;
+		restored = 1;
+	}
+	pthread_mutex_unlock(&idx.lock);
+	return restored;
+}
+static Array* Index_getSystems(void) {
+	Array* entries = NULL;
+	pthread_mutex_lock(&idx.lock);
+	IndexDir* dir = Index_find(ROMS_PATH);
+	if (dir && IndexDir_isFresh(dir)) entries = EntryArray_copy(dir->entries);
+	pthread_mutex_unlock(&idx.lock);
+	if (entries) return entries;
+	
+	dir = IndexDir_stamped(ROMS_PATH);
+	entries = getSystems();
+	Index_store(dir, entries, NULL);
+	return entries;
+}
+
+static void Index_build(Directory* self) {
+	IndexDir* dir = IndexDir_stamped(self->path);
+	self->entries = getEntries(self->path); // unsorted, aliases can change the order
+	Directory_index(self, 1);
+	Index_store(dir, self->entries, self->alphas);
+}
+
+///////////////////////////////////////
+
+static void Index_writeInt(FILE* file, int64_t value) {
+	fwrite(&value, sizeof(value), 1, file);
+}
+static void Index_writeString(FILE* file, char* str) {
+	int64_t len = str ? strlen(str) : -1;
+	Index_writeInt(file, len);
+	if (len>0) fwrite(str, 1, len, file);
+}
+
+typedef struct IndexReader {
+	char* data;
+	size_t size;
+	size_t pos;
+	int error;
+} IndexReader;
+static int64_t Index_readInt(IndexReader* self) {
+	int64_t value = 0;
+	if (self->pos+sizeof(value)>self->size) self->error = 1;
+	else memcpy(&value, self->data+self->pos, sizeof(value));
+	self->pos += sizeof(value);
+	return value;
+}
+static char* Index_readString(IndexReader* self) {
+	int64_t len = Index_readInt(self);
+	if (self->error || len<0) return NULL;
+	if (len>=MAX_PATH || self->pos+len>self->size) {
+		self->error = 1;
+		return NULL;
+	}
+	char* str = malloc(len+1);
+	memcpy(str, self->data+self->pos, len);
+	str[len] = '\0';
+	self->pos += len;
+	return str;
+}
+
+static void Index_save(void) {
+	pthread_mutex_lock(&idx.lock);
+	if (!idx.dirty) {
+		pthread_mutex_unlock(&idx.lock);
+		return;
+	}
+	
+	uint64_t then = getMicroseconds();
+	mkdir(USERDATA_PATH "/.minui", 0755);
+	FILE* file = fopen(INDEX_PATH ".tmp", "wb");
+	if (file) {
+		Index_writeInt(file, INDEX_MAGIC);
+		Index_writeInt(file, INDEX_VERSION);
+		Index_writeInt(file, idx.dirs->count);
+		for (int i=0; i<idx.dirs->count; i++) {
+			IndexDir* dir = idx.dirs->items[i];
+			Index_writeString(file, dir->path);
+			Index_writeInt(file, dir->built);
+			Index_writeInt(file, dir->stamp_count);
+			for (int j=0; j<dir->stamp_count; j++) {
+				Index_writeString(file, dir->stamps[j].path);
+				Index_writeInt(file, dir->stamps[j].mtime);
+			}
+			Index_writeInt(file, dir->entries->count);
+			for (int j=0; j<dir->entries->count; j++) {
+				Entry* entry = dir->entries->items[j];
+				Index_writeString(file, entry->path);
+				Index_writeString(file, entry->name);
+				Index_writeString(file, entry->unique);
+				Index_writeInt(file, entry->type);
+				Index_writeInt(file, entry->alpha);
+			}
+			Index_writeInt(file, dir->alphas.count);
+			for (int j=0; j<dir->alphas.count; j++) {
+				Index_writeInt(file, dir->alphas.items[j]);
+			}
+		}
+		int failed = ferror(file);
+		if (fclose(file) || failed) unlink(INDEX_PATH ".tmp");
+		else {
+			rename(INDEX_PATH ".tmp", INDEX_PATH); // never leaves a half written index behind
+			idx.dirty = 0;
+		}
+	}
+	LOG_info("Index_save: %i listings in %ims\n", idx.dirs->count, (int)((getMicroseconds() - then) / 1000));
+	pthread_mutex_unlock(&idx.lock);
+}
+static void Index_load(void) {
+	idx.dirs = Array_new();
+	
+	FILE* file = fopen(INDEX_PATH, "rb");
+	if (!file) return;
+	fseek(file, 0, SEEK_END);
+	IndexReader reader = {.size = ftell(file)};
+	fseek(file, 0, SEEK_SET);
+	reader.data = malloc(reader.size);
+	if (!reader.data || fread(reader.data, 1, reader.size, file)!=reader.size) reader.error = 1;
+	fclose(file);
+	
+	if (!reader.error && (Index_readInt(&reader)!=INDEX_MAGIC || Index_readInt(&reader)!=INDEX_VERSION)) reader.error = 1;
+	int count = reader.error ? 0 : Index_readInt(&reader);
+	for (int i=0; i<count && !reader.error; i++) {
+		char* path = Index_readString(&reader);
+		if (!path) {
+			reader.error = 1;
+			break;
+		}
+		IndexDir* dir = IndexDir_new(path);
+		free(path);
+		dir->built = Index_readInt(&reader);
+		dir->entries = Array_new();
+		Array_push(idx.dirs, dir);
+		
+		int stamp_count = Index_readInt(&reader);
+		for (int j=0; j<stamp_count && !reader.error; j++) {
+			char* path = Index_readString(&reader);
+			if (!path) {
+				reader.error = 1;
+				break;
+			}
+			IndexDir_addStamp(dir, path, Index_readInt(&reader));
+			free(path);
+		}
+		
+		int entry_count = Index_readInt(&reader);
+		for (int j=0; j<entry_count && !reader.error; j++) {
+			char* path = Index_readString(&reader);
+			char* name = Index_readString(&reader);
+			char* unique = Index_readString(&reader);
+			if (!path || !name) {
+				if (path) free(path);
+				if (name) free(name);
+				if (unique) free(unique);
+				reader.error = 1;
+				break;
+			}
+			Entry* entry = malloc(sizeof(Entry));
+			entry->path = path;
+			entry->name = name;
+			entry->unique = unique;
+			entry->key = NULL;
+			entry->type = Index_readInt(&reader);
+			entry->alpha = Index_readInt(&reader);
+			Array_push(dir->entries, entry);
+		}
+		
+		dir->alphas.count = Index_readInt(&reader);
+		if (dir->alphas.count<0 || dir->alphas.count>INT_ARRAY_MAX) reader.error = 1;
+		for (int j=0; j<dir->alphas.count && !reader.error; j++) {
+			dir->alphas.items[j] = Index_readInt(&reader);
+		}
+	}
+	free(reader.data);
+	
+	if (reader.error) { // start over rather than trust any of it
+		LOG_info("Index_load: ignoring invalid %s\n", INDEX_PATH);
+		for (int i=0; i<idx.dirs->count; i++) {
+			IndexDir_free(idx.dirs->items[i]);
+		}
+		idx.dirs->count = 0;
+		return;
+	}
+	LOG_info("Index_load: %i listings\n", idx.dirs->count);
+}
+
+// checks (and rebuilds) the systems behind the root listing while the
+// menu is already up, so the first open of each is from the index too
+static void* Index_thread(void* arg) {
+	uint64_t then = getMicroseconds();
+	int built = 0;
+	for (int i=0; i<idx.warm->count; i++) {
+		char* path = idx.warm->items[i];
+		pthread_mutex_lock(&idx.lock);
+		IndexDir* dir = Index_find(path);
+		int fresh = dir && IndexDir_isFresh(dir);
+		pthread_mutex_unlock(&idx.lock);
+		if (fresh) continue;
+		
+		Directory tmp = {
+			.path = path,
+			.alphas = IntArray_new(),
+		};
+		Index_build(&tmp);
+		EntryArray_free(tmp.entries);
+		IntArray_free(tmp.alphas);
+		built += 1;
+	}
+	LOG_info("Index_thread: rebuilt %i of %i systems in %ims\n", built, idx.warm->count, (int)((getMicroseconds() - then) / 1000));
+	StringArray_free(idx.warm);
+	Index_save();
+	return NULL;
+}
+static void Index_warm(Directory* root) {
+	idx.warm = Array_new();
+	for (int i=0; i<root->entries->count; i++) {
+		Entry* entry = root->entries->items[i];
+		if (entry->type==ENTRY_DIR && prefixMatch(ROMS_PATH "/", entry->path)) Array_push(idx.warm, strdup(entry->path));
+	}
+	if (pthread_create(&idx.thread, NULL, Index_thread, NULL)) {
+		LOG_info("Index_warm: unable to start thread\n");
+		StringArray_free(idx.warm);
+	}
+	else pthread_detach(idx.thread);
+}
+static void Index_quit(void) {
+	// the thread is left to finish (or not) on its own, a launch
+	// shouldn't wait on it and saves are all or nothing anyway
+	Index_save();
+}
+
+///////////////////////////////////////
+
+// listings that aren't in the index yet are read on a thread, entries
+// show up (sorted and with their map.txt aliases) as they're read,
+// first a screenful then every time the count doubles, and the
+// finished listing, uniques and alpha buckets included, replaces them
+
+typedef struct Loader {
+	pthread_t thread;
+	pthread_mutex_t lock;
+	pthread_cond_t finished; // signaled once done is set
+	char* path;
+	atomic_int cancel; // set by the main thread, polled by the loader
+	int done;
+	Array* ready; // EntryArray, waiting for the main thread
+	IntArray* alphas; // with the finished listing
+} Loader;
+
+static void Loader_publish(Loader* self, Array* entries, IntArray* alphas) {
+	pthread_mutex_lock(&self->lock);
+	if (self->ready) EntryArray_free(self->ready); // never picked up, this is newer
+	self->ready = entries;
+	if (alphas) {
+		self->alphas = alphas;
+		self->done = 1;
+		pthread_cond_signal(&self->finished);
+	}
+	pthread_mutex_unlock(&self->lock);
+	PAD_interrupt();
+}
+static void* Loader_thread(void* arg) {
+	Loader* self = arg;
+	uint64_t then = getMicroseconds();
+	
+	IndexDir* stamped = IndexDir_stamped(self->path);
+	char map_path[256];
+	sprintf(map_path, "%s/map.txt", prefixMatch(COLLECTIONS_PATH, self->path) ? COLLECTIONS_PATH : self->path);
+	Hash* map = Hash_load(map_path);
+	
+	Array* entries = Array_new();
+	int next = MAIN_ROW_COUNT;
+	Array* dirs = getEntryDirs(self->path);
+	for (int i=0; i<dirs->count && !atomic_load(&self->cancel); i++) {
+		DIR* dh = opendir(dirs->items[i]);
+		if (!dh) continue;
+		
+		struct dirent* dp;
+		char full_path[256];
+		sprintf(full_path, "%s/", (char*)dirs->items[i]);
+		char* tmp = full_path + strlen(full_path);
+		while (!atomic_load(&self->cancel) && (dp = readdir(dh))!=NULL) {
+			if (hide(dp->d_name)) continue;
+			strcpy(tmp, dp->d_name);
+			
+			Entry* entry = Entry_new(full_path, getEntryType(full_path, dp));
+			char* alias = map ? Hash_get(map, dp->d_name) : NULL;
+			if (alias) {
+				if (hide(alias)) {
+					Entry_free(entry);
+					continue;
+				}
+				Entry_setName(entry, alias);
+			}
+			Array_push(entries, entry);
+			
+			if (entries->count==next) {
+				EntryArray_sort(entries);
+				Loader_publish(self, EntryArray_copy(entries), NULL);
+				next *= 2;
+			}
+		}
+		closedir(dh);
+	}
+	StringArray_free(dirs);
+	if (map) Hash_free(map);
+	
+	if (atomic_load(&self->cancel)) {
+		EntryArray_free(entries);
+		IndexDir_free(stamped);
+		return NULL;
+	}
+	
+	Directory tmp = {
+		.path = self->path,
+		.entries = entries,
+		.alphas = IntArray_new(),
+	};
+	Directory_index(&tmp, 1);
+	Index_store(stamped, tmp.entries, tmp.alphas);
+	Loader_publish(self, tmp.entries, tmp.alphas);
+	LOG_info("Loader_thread: %s %i entries in %ims\n", self->path, tmp.entries->count, (int)((getMicroseconds() - then) / 1000));
+	return NULL;
+}
+
+static void Directory_load(Directory* self) {
+	self->entries = Array_new();
+	
+	Loader* loader = calloc(1, sizeof(Loader));
+	pthread_mutex_init(&loader->lock, NULL);
+	pthread_cond_init(&loader->finished, NULL);
+	loader->path = strdup(self->path);
+	if (pthread_create(&loader->thread, NULL, Loader_thread, loader)) {
+		LOG_info("Directory_load: unable to start thread\n");
+		pthread_cond_destroy(&loader->finished);
+		pthread_mutex_destroy(&loader->lock);
+		free(loader->path);
+		free(loader);
+		Array_free(self->entries);
+		Index_build(self);
+		return;
+	}
+	self->loader = loader;
+}
+static void Loader_free(Loader* self) { // the only place the thread is joined
+	pthread_join(self->thread, NULL);
+	if (self->ready) EntryArray_free(self->ready);
+	if (self->alphas) IntArray_free(self->alphas);
+	pthread_cond_destroy(&self->finished);
+	pthread_mutex_destroy(&self->lock);
+	free(self->path);
+	free(self);
+}
+// takes whatever the loader has read since the last call, keeping the
+// same entry selected, returns 1 if the listing changed
+static int Directory_update(Directory* self) {
+	Loader* loader = self->loader;
+	if (!loader) return 0;
+	
+	pthread_mutex_lock(&loader->lock);
+	Array* entries = loader->ready;
+	IntArray* alphas = loader->alphas;
+	int done = loader->done;
+	loader->ready = NULL;
+	loader->alphas = NULL;
+	pthread_mutex_unlock(&loader->lock);
+	if (!entries) return 0;
+	
+	int selected = self->selected;
+	if (self->entries->count) {
+		Entry* entry = self->entries->items[self->selected];
+		selected = EntryArray_indexOf(entries, entry->path);
+		if (selected==-1) selected = self->selected;
+	}
+	EntryArray_free(self->entries);
+	self->entries = entries;
+	if (done) {
+		memcpy(self->alphas, alphas, sizeof(IntArray));
+		IntArray_free(alphas);
+		Loader_free(loader);
+		self->loader = NULL;
+	}
+	
+	int total = entries->count;
+	self->selected = MAX(0, MIN(selected, total-1));
+	self->end = MIN(total, self->start + MAIN_ROW_COUNT);
+	if (self->selected<self->start || self->selected>=self->end) {
+		self->end = MIN(total, MAX(self->selected+1, MAIN_ROW_COUNT));
+	}
+	self->start = MAX(0, self->end - MAIN_ROW_COUNT);
+	return 1;
+}
+// blocks until the listing is complete
+static void Directory_wait(Directory* self) {
+	Loader* loader = self->loader;
+	if (!loader) return;
+	pthread_mutex_lock(&loader->lock);
+	while (!loader->done) pthread_cond_wait(&loader->finished, &loader->lock);
+	pthread_mutex_unlock(&loader->lock);
+	Directory_update(self); // takes the finished listing and frees the loader
+}
+static void Directory_cancel(Directory* self) {
+	if (!self->loader) return;
+	atomic_store(&self->loader->cancel, 1);
+	Loader_free(self->loader);
+	self->loader = NULL;
+}
+
+///////////////////////////////////////
+
 static void queueNext(char* cmd) {
 	LOG_info("cmd: %s\n", cmd);
 	putFile("/tmp/next", cmd);
@@ -1168,7 +1801,7 @@ static void openDirectory(char* path, int auto_launch) {
 	
 	top = Directory_new(path, selected);
 	top->start = start;
-	top->end = end ? end : ((top->entries->count<MAIN_ROW_COUNT) ? top->entries->count : MAIN_ROW_COUNT);
+	top->end = MIN(top->entries->count, end ? end : MAIN_ROW_COUNT); // still loading, Directory_update() takes it from here
 
 	Array_push(stack, top);
 }
@@ -1252,6 +1885,7 @@ static void loadLast(void) { // call after loading root directory
 				if (tmp) tmp[1] = '\0'; // 1 because we want to keep the opening parenthesis to avoid collating "Game Boy Color" and "Game Boy Advance" into "Game Boy"
 			}
 			
+			Directory_wait(top); // can't restore a selection that hasn't been read yet
 			for (int i=0; i<top->entries->count; i++) {
 				Entry* entry = top->entries->items[i];
 			
@@ -1283,24 +1917,712 @@ static void loadLast(void) { // call after loading root directory
 
 ///////////////////////////////////////
 
+// thumbnails are decoded (and scaled down to fit, and flattened to the
+// screen format) on their own thread so holding a direction through a
+// folder of box art doesn't stall on IMG_Load, the entries around the
+// selection are decoded ahead of time and the last few megabytes of
+// them are kept around. thumbnails that had to be scaled down are also
+// written out pre-scaled so the next decode is just a read
+
+#define THUMB_CACHE_BYTES (8 * 1024 * 1024)
+#define THUMB_CACHE_COUNT 128 // keeps Thumb_find short when most entries have no thumbnail
+#define THUMB_PREFETCH 2 // entries either side of the selection
+#define THUMB_QUEUE_SIZE (1 + THUMB_PREFETCH * 2)
+#define THUMB_DISK_PATH USERDATA_PATH "/.minui/thumbs"
+#define THUMB_DISK_MAGIC 0x42485454 // TTHB
+
+typedef struct Thumb {
+	char* path;
+	SDL_Surface* surface; // NULL when there isn't one
+	uint32_t used;
+} Thumb;
+
+typedef struct ThumbHeader {
+	uint32_t magic;
+	uint16_t width;
+	uint16_t height;
+	int64_t mtime; // of the png it was scaled from
+	int64_t size;
+} ThumbHeader;
+
+static struct Thumbs {
+	pthread_t thread;
+	pthread_mutex_t lock;
+	pthread_cond_t cond;
+	int running;
+	int quit;
+	
+	// shared with the thread
+	char* queue[THUMB_QUEUE_SIZE]; // most wanted first
+	int queued;
+	char* decoding;
+	Array* done; // Thumb
+	
+	// main thread only
+	Array* cache; // Thumb
+	int bytes;
+	uint32_t clock;
+	char* waiting; // selected but not decoded yet
+} thumbs = {
+	.lock = PTHREAD_MUTEX_INITIALIZER,
+	.cond = PTHREAD_COND_INITIALIZER,
+};
+
+static void getThumbPath(char* path, char* res_path) {
+	// a thumbnail for a file or folder named NAME.EXT needs a corresponding /.res/NAME.EXT.png
+	char res_root[MAX_PATH];
+	strcpy(res_root, path);
+	char* tmp = strrchr(res_root, '/');
+	tmp[0] = '\0';
+	sprintf(res_path, "%s/.res/%s.png", res_root, tmp+1);
+}
+static void getThumbDiskPath(char* res_path, char* disk_path) {
+	uint32_t hash = 2166136261u; // fnv-1a
+	for (char* c=res_path; *c; c++) {
+		hash ^= (uint8_t)*c;
+		hash *= 16777619u;
+	}
+	sprintf(disk_path, "%s/%08x.565", THUMB_DISK_PATH, hash);
+}
+
+static uint32_t getPixel(SDL_Surface* surface, int x, int y) {
+	uint8_t* p = (uint8_t*)surface->pixels + y * surface->pitch + x * surface->format->BytesPerPixel;
+	switch (surface->format->BytesPerPixel) {
+		case 1: return *p;
+		case 2: return *(uint16_t*)p;
+		case 3: return p[0] | (p[1] << 8) | (p[2] << 16); // little endian
+		default: return *(uint32_t*)p;
+	}
+}
+static SDL_Surface* Thumb_read(char* disk_path, struct stat* st) {
+	SDL_Surface* thumb = NULL;
+	FILE* file = fopen(disk_path, "rb");
+	if (!file) return thumb;
+	
+	ThumbHeader header;
+	if (fread(&header, sizeof(header), 1, file)==1 && header.magic==THUMB_DISK_MAGIC && header.mtime==st->st_mtime && header.size==st->st_size
+		// only ever written scaled down to fit, anything else is corrupt
+		&& header.width>0 && header.width<=FIXED_HEIGHT && header.height>0 && header.height<=FIXED_HEIGHT
+	) {
+		thumb = SDL_CreateRGBSurface(SDL_SWSURFACE, header.width,header.height, FIXED_DEPTH, RGBA_MASK_565);
+		for (int y=0; thumb && y<thumb->h; y++) {
+			if (fread((uint8_t*)thumb->pixels + y * thumb->pitch, FIXED_BPP, thumb->w, file)!=thumb->w) {
+				SDL_FreeSurface(thumb);
+				thumb = NULL;
+				break;
+			}
+		}
+	}
+	fclose(file);
+	return thumb;
+}
+static void Thumb_write(char* disk_path, struct stat* st, SDL_Surface* thumb) {
+	mkdir(USERDATA_PATH "/.minui", 0755);
+	mkdir(THUMB_DISK_PATH, 0755);
+	
+	char tmp_path[MAX_PATH];
+	sprintf(tmp_path, "%s.tmp", disk_path);
+	FILE* file = fopen(tmp_path, "wb");
+	if (!file) return;
+	
+	ThumbHeader header = {
+		.magic = THUMB_DISK_MAGIC,
+		.width = thumb->w,
+		.height = thumb->h,
+		.mtime = st->st_mtime,
+		.size = st->st_size,
+	};
+	fwrite(&header, sizeof(header), 1, file);
+	for (int y=0; y<thumb->h; y++) {
+		fwrite((uint8_t*)thumb->pixels + y * thumb->pitch, FIXED_BPP, thumb->w, file);
+	}
+	int failed = ferror(file);
+	if (fclose(file) || failed) unlink(tmp_path);
+	else rename(tmp_path, disk_path);
+}
+static SDL_Surface* Thumb_decode(char* res_path) {
+	struct stat st;
+	if (stat(res_path, &st)) return NULL;
+	
+	char disk_path[MAX_PATH];
+	getThumbDiskPath(res_path, disk_path);
+	SDL_Surface* thumb = Thumb_read(disk_path, &st);
+	if (thumb) return thumb;
+	
+	SDL_Surface* image = IMG_Load(res_path);
+	if (!image) return NULL;
+	
+	// fit (never enlarge) to FIXED_HEIGHT x FIXED_HEIGHT
+	int w = image->w;
+	int h = image->h;
+	if (w>FIXED_HEIGHT || h>FIXED_HEIGHT) {
+		if (w>=h) {
+			h = MAX(1, h * FIXED_HEIGHT / w);
+			w = FIXED_HEIGHT;
+		}
+		else {
+			w = MAX(1, w * FIXED_HEIGHT / h);
+			h = FIXED_HEIGHT;
+		}
+	}
+	
+	// averages the source pixels under each destination pixel and
+	// flattens any alpha against the black it's drawn over
+	thumb = SDL_CreateRGBSurface(SDL_SWSURFACE, w,h, FIXED_DEPTH, RGBA_MASK_565);
+	if (!thumb) {
+		SDL_FreeSurface(image);
+		return NULL;
+	}
+	if (SDL_MUSTLOCK(image)) SDL_LockSurface(image);
+	for (int dy=0; dy<h; dy++) {
+		int sy0 = dy * image->h / h;
+		int sy1 = MAX(sy0+1, (dy+1) * image->h / h);
+		uint16_t* dst = (uint16_t*)((uint8_t*)thumb->pixels + dy * thumb->pitch);
+		for (int dx=0; dx<w; dx++) {
+			int sx0 = dx * image->w / w;
+			int sx1 = MAX(sx0+1, (dx+1) * image->w / w);
+			uint64_t r = 0, g = 0, b = 0, n = 0;
+			for (int sy=sy0; sy<sy1; sy++) {
+				for (int sx=sx0; sx<sx1; sx++) {
+					uint8_t cr,cg,cb,ca;
+					SDL_GetRGBA(getPixel(image, sx,sy), image->format, &cr,&cg,&cb,&ca);
+					r += cr * ca;
+					g += cg * ca;
+					b += cb * ca;
+					n += 1;
+				}
+			}
+			n *= 255;
+			dst[dx] = ((r / n) >> 3) << 11 | ((g / n) >> 2) << 5 | ((b / n) >> 3);
+		}
+	}
+	if (SDL_MUSTLOCK(image)) SDL_UnlockSurface(image);
+	
+	if (w!=image->w || h!=image->h) Thumb_write(disk_path, &st, thumb);
+	SDL_FreeSurface(image);
+	return thumb;
+}
+
+static void* Thumb_thread(void* arg) {
+	pthread_mutex_lock(&thumbs.lock);
+	while (!thumbs.quit) {
+		if (!thumbs.queued) {
+			pthread_cond_wait(&thumbs.cond, &thumbs.lock);
+			continue;
+		}
+		
+		char* path = thumbs.queue[0];
+		thumbs.queued -= 1;
+		memmove(&thumbs.queue[0], &thumbs.queue[1], sizeof(char*) * thumbs.queued);
+		thumbs.decoding = path;
+		pthread_mutex_unlock(&thumbs.lock);
+		
+		Thumb* thumb = malloc(sizeof(Thumb));
+		thumb->path = path;
+		thumb->surface = Thumb_decode(path);
+		
+		pthread_mutex_lock(&thumbs.lock);
+		thumbs.decoding = NULL;
+		Array_push(thumbs.done, thumb);
+		PAD_interrupt(); // wake the menu if it's idle
+	}
+	pthread_mutex_unlock(&thumbs.lock);
+	return NULL;
+}
+
+static int Thumb_bytes(Thumb* thumb) {
+	// entries without a thumbnail still cost their bookkeeping so
+	// a folder without box art can't grow the cache unbounded
+	int bytes = sizeof(Thumb) + strlen(thumb->path) + 1;
+	if (thumb->surface) bytes += thumb->surface->h * thumb->surface->pitch;
+	return bytes;
+}
+static void Thumb_free(Thumb* thumb) {
+	if (thumb->surface) SDL_FreeSurface(thumb->surface);
+	free(thumb->path);
+	free(thumb);
+}
+static Thumb* Thumb_find(char* path) {
+	for (int i=0; i<thumbs.cache->count; i++) {
+		Thumb* thumb = thumbs.cache->items[i];
+		if (exactMatch(thumb->path, path)) return thumb;
+	}
+	return NULL;
+}
+// every insert goes through here so the bytes always match the cache
+static void Thumb_insert(Thumb* thumb) {
+	thumb->used = ++thumbs.clock;
+	thumbs.bytes += Thumb_bytes(thumb);
+	Array_push(thumbs.cache, thumb);
+	
+	// evict the least recently used, but never the one just inserted
+	while ((thumbs.bytes>THUMB_CACHE_BYTES || thumbs.cache->count>THUMB_CACHE_COUNT) && thumbs.cache->count>1) {
+		int oldest = 0;
+		for (int i=1; i<thumbs.cache->count; i++) {
+			if (((Thumb*)thumbs.cache->items[i])->used<((Thumb*)thumbs.cache->items[oldest])->used) oldest = i;
+		}
+		Thumb* old = thumbs.cache->items[oldest];
+		thumbs.bytes -= Thumb_bytes(old);
+		Thumb_free(old);
+		thumbs.cache->count -= 1;
+		memmove(&thumbs.cache->items[oldest], &thumbs.cache->items[oldest+1], sizeof(void*) * (thumbs.cache->count - oldest));
+	}
+}
+// moves finished decodes into the cache, returns 1 when the one
+// on screen just finished and it needs to be redrawn
+static int Thumb_update(void) {
+	if (!thumbs.running) return 0;
+	
+	pthread_mutex_lock(&thumbs.lock);
+	Array* done = thumbs.done;
+	if (done->count) thumbs.done = Array_new();
+	pthread_mutex_unlock(&thumbs.lock);
+	if (!done->count) return 0;
+	
+	int ready = 0;
+	for (int i=0; i<done->count; i++) {
+		Thumb* thumb = done->items[i];
+		if (Thumb_find(thumb->path)) {
+			Thumb_free(thumb);
+			continue;
+		}
+		if (thumbs.waiting && exactMatch(thumb->path, thumbs.waiting)) {
+			free(thumbs.waiting);
+			thumbs.waiting = NULL;
+			ready = 1;
+		}
+		Thumb_insert(thumb);
+	}
+	Array_free(done);
+	return ready;
+}
+
+// returns the thumbnail for the selected entry of dir if it's been
+// decoded, has_thumb is set if one exists at all (so the list can make
+// room for it while it's still decoding) and its neighbors get queued
+static SDL_Surface* Thumb_get(Directory* dir, int* has_thumb) {
+	*has_thumb = 0;
+	if (!thumbs.running || !dir->entries->count) return NULL;
+	Thumb_update();
+	
+	char* queue[THUMB_QUEUE_SIZE];
+	int queued = 0;
+	SDL_Surface* surface = NULL;
+	for (int i=0; i<THUMB_QUEUE_SIZE; i++) {
+		int offset = (i + 1) / 2 * (i % 2 ? 1 : -1); // 0,1,-1,2,-2...
+		int index = dir->selected + offset;
+		if (index<0 || index>=dir->entries->count) continue;
+		
+		Entry* entry = dir->entries->items[index];
+		char res_path[MAX_PATH];
+		getThumbPath(entry->path, res_path);
+		
+		Thumb* thumb = Thumb_find(res_path);
+		if (thumb) {
+			thumb->used = ++thumbs.clock;
+			if (offset==0) {
+				surface = thumb->surface;
+				*has_thumb = surface!=NULL;
+			}
+			continue;
+		}
+		
+		if (offset==0) {
+			if (thumbs.waiting) free(thumbs.waiting);
+			thumbs.waiting = NULL;
+			*has_thumb = exists(res_path);
+			if (!*has_thumb) { // not worth the thread
+				thumb = calloc(1, sizeof(Thumb));
+				thumb->path = strdup(res_path);
+				Thumb_insert(thumb);
+				continue;
+			}
+			thumbs.waiting = strdup(res_path);
+		}
+		queue[queued++] = strdup(res_path);
+	}
+	
+	// replace whatever was still waiting to be decoded
+	pthread_mutex_lock(&thumbs.lock);
+	for (int i=0; i<thumbs.queued; i++) {
+		free(thumbs.queue[i]);
+	}
+	thumbs.queued = 0;
+	for (int i=0; i<queued; i++) {
+		if (thumbs.decoding && exactMatch(thumbs.decoding, queue[i])) free(queue[i]);
+		else thumbs.queue[thumbs.queued++] = queue[i];
+	}
+	if (thumbs.queued) pthread_cond_signal(&thumbs.cond);
+	pthread_mutex_unlock(&thumbs.lock);
+	
+	return surface;
+}
+
+static void Thumb_init(void) {
+	thumbs.done = Array_new();
+	thumbs.cache = Array_new();
+	thumbs.running = !pthread_create(&thumbs.thread, NULL, Thumb_thread, NULL);
+	if (!thumbs.running) LOG_info("Thumb_init: unable to start thread\n");
+}
+static void Thumb_quit(void) {
+	if (!thumbs.running) return;
+	
+	pthread_mutex_lock(&thumbs.lock);
+	thumbs.quit = 1;
+	pthread_cond_signal(&thumbs.cond);
+	pthread_mutex_unlock(&thumbs.lock);
+	pthread_join(thumbs.thread, NULL); // after the decode in progress, if any
+	thumbs.running = 0;
+	
+	for (int i=0; i<thumbs.queued; i++) {
+		free(thumbs.queue[i]);
+	}
+	for (int i=0; i<thumbs.done->count; i++) {
+		Thumb_free(thumbs.done->items[i]);
+	}
+	for (int i=0; i<thumbs.cache->count; i++) {
+		Thumb_free(thumbs.cache->items[i]);
+	}
+	Array_free(thumbs.done);
+	Array_free(thumbs.cache);
+	if (thumbs.waiting) free(thumbs.waiting);
+}
+
+///////////////////////////////////////
+
+// search, Y from any list opens a faux Search folder whose entries are
+// the best matches for a query across every system. the query is typed
+// arcade style, left/right cycles the last character, Y adds another
+// and B takes one away. names come from the library index (see Index_*)
+// and are indexed by trigram the first time search is opened so each
+// change to the query only touches the names that share a trigram
+
+#define SEARCH_CHARS " ABCDEFGHIJKLMNOPQRSTUVWXYZ0123456789"
+#define SEARCH_MAX_QUERY 32
+#define SEARCH_MAX_RESULTS 100
+#define SEARCH_DEPTH 4 // folders within a system
+#define SEARCH_SYMBOLS 37 // space, a-z, 0-9
+#define SEARCH_TRIGRAMS (SEARCH_SYMBOLS * SEARCH_SYMBOLS * SEARCH_SYMBOLS)
+
+typedef struct SearchItem {
+	char* path;
+	char* name;
+	char* norm; // lowercase words padded by spaces, eg. " super mario land 2 "
+	int type;
+} SearchItem;
+
+typedef struct SearchMatch {
+	int item;
+	int score;
+} SearchMatch;
+
+static struct Search {
+	int built;
+	int count;
+	int capacity;
+	SearchItem* items;
+	int* offsets; // into postings, per trigram
+	int* postings; // item indexes
+	uint8_t* hits; // per item, scratch for Search_find
+	int* touched; // items with hits
+	char query[SEARCH_MAX_QUERY+1];
+} search;
+
+static int searchSymbol(char c) {
+	if (c>='a' && c<='z') return c - 'a' + 1;
+	if (c>='0' && c<='9') return c - '0' + 27;
+	return 0;
+}
+static void searchNormalize(char* in, char* out, int size) {
+	int len = 0;
+	out[len++] = ' ';
+	for (char* c=in; *c && len<size-2; c++) {
+		char l = tolower(*c);
+		if (searchSymbol(l)) out[len++] = l;
+		else if (out[len-1]!=' ') out[len++] = ' ';
+	}
+	if (out[len-1]!=' ') out[len++] = ' ';
+	out[len] = '\0';
+}
+static int searchTrigrams(char* norm, int* trigrams) { // unique, returns count
+	int count = 0;
+	for (int i=0; norm[i] && norm[i+1] && norm[i+2]; i++) {
+		int trigram = (searchSymbol(norm[i]) * SEARCH_SYMBOLS + searchSymbol(norm[i+1])) * SEARCH_SYMBOLS + searchSymbol(norm[i+2]);
+		int j = 0;
+		while (j<count && trigrams[j]!=trigram) j += 1;
+		if (j==count) trigrams[count++] = trigram;
+	}
+	return count;
+}
+
+static void Search_add(Entry* entry) {
+	if (search.count==search.capacity) {
+		search.capacity = search.capacity ? search.capacity * 2 : 1024;
+		search.items = realloc(search.items, sizeof(SearchItem) * search.capacity);
+	}
+	char norm[MAX_PATH];
+	searchNormalize(entry->name, norm, MAX_PATH);
+	
+	SearchItem* item = &search.items[search.count++];
+	item->path = strdup(entry->path);
+	item->name = strdup(entry->name);
+	item->norm = strdup(norm);
+	item->type = entry->type;
+}
+static void Search_addListing(char* path, int depth) {
+	Directory tmp = {
+		.path = path,
+		.alphas = IntArray_new(),
+	};
+	if (!Index_restore(&tmp)) Index_build(&tmp);
+	for (int i=0; i<tmp.entries->count; i++) {
+		Entry* entry = tmp.entries->items[i];
+		Search_add(entry);
+		if (entry->type==ENTRY_DIR && depth<SEARCH_DEPTH) Search_addListing(entry->path, depth+1);
+	}
+	EntryArray_free(tmp.entries);
+	IntArray_free(tmp.alphas);
+}
+static void Search_build(void) {
+	uint64_t then = getMicroseconds();
+	
+	Array* systems = Index_getSystems();
+	for (int i=0; i<systems->count; i++) {
+		Entry* entry = systems->items[i];
+		Search_addListing(entry->path, 1);
+	}
+	EntryArray_free(systems);
+	
+	// count then fill so each trigram's items are contiguous (and in order)
+	int trigrams[MAX_PATH];
+	search.offsets = calloc(SEARCH_TRIGRAMS + 1, sizeof(int));
+	for (int i=0; i<search.count; i++) {
+		int count = searchTrigrams(search.items[i].norm, trigrams);
+		for (int j=0; j<count; j++) {
+			search.offsets[trigrams[j]+1] += 1;
+		}
+	}
+	for (int i=0; i<SEARCH_TRIGRAMS; i++) {
+		search.offsets[i+1] += search.offsets[i];
+	}
+	int postings = MAX(1, search.offsets[SEARCH_TRIGRAMS]); // MAX isn't parenthesized, keep it out of the multiply
+	search.postings = malloc(sizeof(int) * postings);
+	int* fill = malloc(sizeof(int) * SEARCH_TRIGRAMS);
+	memcpy(fill, search.offsets, sizeof(int) * SEARCH_TRIGRAMS);
+	for (int i=0; i<search.count; i++) {
+		int count = searchTrigrams(search.items[i].norm, trigrams);
+		for (int j=0; j<count; j++) {
+			search.postings[fill[trigrams[j]]++] = i;
+		}
+	}
+	free(fill);
+	
+	int slots = MAX(1, search.count);
+	search.hits = calloc(slots, sizeof(uint8_t));
+	search.touched = malloc(sizeof(int) * slots);
+	search.built = 1;
+	
+	LOG_info("Search_build: %i names, %i postings in %ims\n", search.count, search.offsets[SEARCH_TRIGRAMS], (int)((getMicroseconds() - then) / 1000));
+}
+
+static int SearchMatch_sort(const void* a, const void* b) {
+	SearchMatch* ma = (SearchMatch*)a;
+	SearchMatch* mb = (SearchMatch*)b;
+	if (ma->score!=mb->score) return mb->score - ma->score;
+	return strcasecmp(search.items[ma->item].name, search.items[mb->item].name);
+}
+static int Search_score(SearchItem* item, char* query, int hits) {
+	int score = hits * 16;
+	char* found = strstr(item->norm, query); // query starts with a space so this is a word prefix
+	if (found) score += found==item->norm ? 256 : 128;
+	else if (strstr(item->norm, query+1)) score += 64;
+	return score - strlen(item->norm); // shorter names are closer matches
+}
+// keeps the best SEARCH_MAX_RESULTS in a heap with the worst on top
+static void searchKeep(SearchMatch* heap, int* count, int item, int score) {
+	SearchMatch match = {item, score};
+	int i;
+	if (*count<SEARCH_MAX_RESULTS) {
+		i = (*count)++;
+		while (i>0 && SearchMatch_sort(&heap[(i-1)/2], &match)<0) {
+			heap[i] = heap[(i-1)/2];
+			i = (i-1) / 2;
+		}
+	}
+	else if (SearchMatch_sort(&match, &heap[0])<0) {
+		i = 0;
+		while (1) {
+			int child = i * 2 + 1;
+			if (child>=*count) break;
+			if (child+1<*count && SearchMatch_sort(&heap[child], &heap[child+1])<0) child += 1;
+			if (SearchMatch_sort(&heap[child], &match)<=0) break;
+			heap[i] = heap[child];
+			i = child;
+		}
+	}
+	else return;
+	heap[i] = match;
+}
+static Array* Search_find(char* text) {
+	Array* entries = Array_new();
+	if (!search.built || !text[0]) return entries;
+	
+	char query[SEARCH_MAX_QUERY+4];
+	searchNormalize(text, query, sizeof(query));
+	query[strlen(query)-1] = '\0'; // the last word can be partial
+	if (!query[0]) return entries; // just spaces
+	
+	uint64_t then = getMicroseconds();
+	SearchMatch matches[SEARCH_MAX_RESULTS];
+	int count = 0;
+	int total = 0;
+	int trigrams[MAX(SEARCH_MAX_QUERY, SEARCH_SYMBOLS)];
+	int trigram_count = searchTrigrams(query, trigrams);
+	int need = trigram_count - trigram_count / 4; // so a typo or a missing word still finds the title
+	if (!trigram_count) { // a single letter, any word starting with it
+		for (int i=0; i<SEARCH_SYMBOLS; i++) {
+			trigrams[trigram_count++] = searchSymbol(query[1]) * SEARCH_SYMBOLS + i;
+		}
+		need = 1;
+	}
+	
+	int touched = 0;
+	for (int i=0; i<trigram_count; i++) {
+		int* posting = &search.postings[search.offsets[trigrams[i]]];
+		int* end = &search.postings[search.offsets[trigrams[i]+1]];
+		for (; posting<end; posting++) {
+			if (!search.hits[*posting]++) search.touched[touched++] = *posting;
+		}
+	}
+	for (int i=0; i<touched; i++) {
+		int index = search.touched[i];
+		int hits = search.hits[index];
+		search.hits[index] = 0;
+		if (hits<need) continue;
+		searchKeep(matches, &count, index, Search_score(&search.items[index], query, hits));
+		total += 1;
+	}
+	qsort(matches, count, sizeof(SearchMatch), SearchMatch_sort);
+	
+	for (int i=0; i<count; i++) {
+		SearchItem* item = &search.items[matches[i].item];
+		Entry* entry = malloc(sizeof(Entry));
+		entry->path = strdup(item->path);
+		entry->name = strdup(item->name);
+		entry->key = NULL;
+		entry->type = item->type;
+		entry->alpha = 0;
+		
+		char unique[MAX_PATH]; // results span systems, tag them
+		getUniqueName(entry, unique);
+		entry->unique = strdup(unique);
+		Array_push(entries, entry);
+	}
+	LOG_info("Search_find: \"%s\" %i matches in %ius\n", text, total, (int)(getMicroseconds() - then));
+	return entries;
+}
+
+static Array* Search_current(void) {
+	return Search_find(search.query);
+}
+static int Search_isOpen(void) {
+	return exactMatch(top->path, FAUX_SEARCH_PATH);
+}
+static void Search_open(SDL_Surface* screen) {
+	if (!search.built) {
+		GFX_clear(screen);
+		GFX_blitMessage(font.large, "Indexing library...", screen, &(SDL_Rect){0,0,screen->w,screen->h});
+		GFX_flip(screen);
+		Search_build();
+	}
+	strcpy(search.query, "A");
+	openDirectory(FAUX_SEARCH_PATH, 0);
+}
+static void Search_refresh(void) {
+	EntryArray_free(top->entries);
+	top->entries = Search_find(search.query);
+	top->selected = 0;
+	top->start = 0;
+	top->end = MIN(top->entries->count, MAIN_ROW_COUNT);
+}
+// returns 1 if it handled the input
+static int Search_input(void) {
+	int len = strlen(search.query);
+	char* chars = SEARCH_CHARS;
+	int count = strlen(chars);
+	if (PAD_justRepeated(BTN_LEFT) || PAD_justRepeated(BTN_RIGHT)) {
+		int i = strchr(chars, search.query[len-1]) - chars;
+		i = (i + (PAD_justRepeated(BTN_LEFT) ? count-1 : 1)) % count;
+		search.query[len-1] = chars[i];
+	}
+	else if (PAD_justPressed(BTN_Y) && len<SEARCH_MAX_QUERY) {
+		search.query[len] = search.query[len-1]; // double letters are common enough
+		search.query[len+1] = '\0';
+	}
+	else if (PAD_justRepeated(BTN_B) && len>1) {
+		search.query[len-1] = '\0';
+	}
+	else return 0;
+	
+	Search_refresh();
+	return 1;
+}
+static void Search_blitQuery(SDL_Surface* screen) {
+	char prefix[SEARCH_MAX_QUERY+1];
+	strcpy(prefix, search.query);
+	char last[2] = {prefix[strlen(prefix)-1], '\0'};
+	prefix[strlen(prefix)-1] = '\0';
+	if (last[0]==' ') last[0] = '_';
+	
+	int text_width = 0;
+	SDL_Surface* text = prefix[0] ? GFX_getText(font.large, prefix, screen->w / 2, 0, COLOR_WHITE, &text_width) : NULL;
+	int ox = SCALE1(PADDING);
+	int oy = screen->h - SCALE1(PADDING + PILL_SIZE);
+	int ow = SCALE1(BUTTON_MARGIN) + (text ? text_width + SCALE1(BUTTON_MARGIN) : 0) + SCALE1(BUTTON_SIZE) + SCALE1(BUTTON_MARGIN) + GFX_getButtonWidth("ADD", "Y") + SCALE1(BUTTON_MARGIN);
+	GFX_blitPill(ASSET_DARK_GRAY_PILL, screen, &(SDL_Rect){ox, oy, ow, SCALE1(PILL_SIZE)});
+	
+	ox += SCALE1(BUTTON_MARGIN);
+	if (text) {
+		SDL_BlitSurface(text, NULL, screen, &(SDL_Rect){ox + SCALE1(BUTTON_MARGIN), oy + (SCALE1(PILL_SIZE) - text->h) / 2});
+		ox += text_width + SCALE1(BUTTON_MARGIN);
+	}
+	
+	// the character left/right changes
+	GFX_blitAsset(ASSET_BUTTON, NULL, screen, &(SDL_Rect){ox, oy + SCALE1(BUTTON_MARGIN)});
+	text = GFX_getText(font.medium, last, SCALE1(BUTTON_SIZE), 0, COLOR_BUTTON_TEXT, NULL);
+	SDL_BlitSurface(text, NULL, screen, &(SDL_Rect){ox + (SCALE1(BUTTON_SIZE) - text->w) / 2, oy + SCALE1(BUTTON_MARGIN) + (SCALE1(BUTTON_SIZE) - text->h) / 2});
+	ox += SCALE1(BUTTON_SIZE) + SCALE1(BUTTON_MARGIN);
+	
+	GFX_blitButton("ADD", "Y", screen, &(SDL_Rect){ox, oy + SCALE1(BUTTON_MARGIN)});
+}
+
+///////////////////////////////////////
+
 static void Menu_init(void) {
 	stack = Array_new(); // array of open Directories
 	recents = Array_new();
 
+	Index_load();
 	openDirectory(SDCARD_PATH, 0);
+	TRACE_mark("Menu_init root");
 	loadLast(); // restore state when available
+	TRACE_mark("loadLast");
+	Index_warm(stack->items[0]);
+	Thumb_init();
 }
 static void Menu_quit(void) {
+	Thumb_quit();
+	Index_quit();
 	RecentArray_free(recents);
 	DirectoryArray_free(stack);
 }
 
 ///////////////////////////////////////
 
+#define IDLE_TIMEOUT 1000 // ms, charging, wifi, hdmi, mute and autosleep are still polled this often when idle
+
 int main (int argc, char *argv[]) {
-	// LOG_info("time from launch to:\n");
-	// unsigned long main_begin = SDL_GetTicks();
-	// unsigned long first_draw = 0;
+	TRACE_init("minui");
 	
 	if (autoResume()) return 0; // nothing to do
 	
@@ -1310,19 +2632,18 @@ int main (int argc, char *argv[]) {
 	InitSettings();
 	
 	SDL_Surface* screen = GFX_init(MODE_MAIN);
-	// LOG_info("- graphics init: %lu\n", SDL_GetTicks() - main_begin);
 	
 	PAD_init();
-	// LOG_info("- input init: %lu\n", SDL_GetTicks() - main_begin);
+	TRACE_mark("PAD_init");
 	
 	PWR_init();
 	if (!HAS_POWER_BUTTON && !simple_mode) PWR_disableSleep();
-	// LOG_info("- power init: %lu\n", SDL_GetTicks() - main_begin);
+	TRACE_mark("PWR_init");
 	
 	SDL_Surface* version = NULL;
 	
 	Menu_init();
-	// LOG_info("- menu init: %lu\n", SDL_GetTicks() - main_begin);
+	TRACE_mark("Menu_init");
 	
 	// now that (most of) the heavy lifting is done, take a load off
 	PWR_setCPUSpeed(CPU_SPEED_MENU);
@@ -1334,12 +2655,13 @@ int main (int argc, char *argv[]) {
 	int show_setting = 0; // 1=brightness,2=volume
 	int was_online = PLAT_isOnline();
 	
-	// LOG_info("- loop start: %lu\n", SDL_GetTicks() - main_begin);
 	while (!quit) {
 		GFX_startFrame();
 		unsigned long now = SDL_GetTicks();
 		
 		PAD_poll();
+		
+		if (Directory_update(top)) dirty = 1;
 			
 		int selected = top->selected;
 		int total = top->entries->count;
@@ -1350,6 +2672,8 @@ int main (int argc, char *argv[]) {
 		if (was_online!=is_online) dirty = 1;
 		was_online = is_online;
 		
+		if (Thumb_update()) dirty = 1;
+		
 		if (show_version) {
 			if (PAD_justPressed(BTN_B) || PAD_tappedMenu(now)) {
 				show_version = 0;
@@ -1363,6 +2687,11 @@ int main (int argc, char *argv[]) {
 				dirty = 1;
 				if (!HAS_POWER_BUTTON && !simple_mode) PWR_enableSleep();
 			}
+			else if (Search_isOpen() && Search_input()) {
+				selected = top->selected;
+				total = top->entries->count;
+				dirty = 1;
+			}
 			else if (total>0) {
 				if (PAD_justRepeated(BTN_UP)) {
 					if (selected==0 && !PAD_justPressed(BTN_UP)) {
@@ -1428,7 +2757,7 @@ int main (int argc, char *argv[]) {
 				}
 			}
 		
-			if (PAD_justRepeated(BTN_L1) && !PAD_isPressed(BTN_R1) && !PWR_ignoreSettingInput(BTN_L1, show_setting)) { // previous alpha
+			if (total>0 && PAD_justRepeated(BTN_L1) && !PAD_isPressed(BTN_R1) && !PWR_ignoreSettingInput(BTN_L1, show_setting)) { // previous alpha
 				Entry* entry = top->entries->items[selected];
 				int i = entry->alpha-1;
 				if (i>=0) {
@@ -1441,7 +2770,7 @@ int main (int argc, char *argv[]) {
 					}
 				}
 			}
-			else if (PAD_justRepeated(BTN_R1) && !PAD_isPressed(BTN_L1) && !PWR_ignoreSettingInput(BTN_R1, show_setting)) { // next alpha
+			else if (total>0 && PAD_justRepeated(BTN_R1) && !PAD_isPressed(BTN_L1) && !PWR_ignoreSettingInput(BTN_R1, show_setting)) { // next alpha
 				Entry* entry = top->entries->items[selected];
 				int i = entry->alpha+1;
 				if (i<top->alphas->count) {
@@ -1481,6 +2810,12 @@ int main (int argc, char *argv[]) {
 				// can_resume = 0;
 				if (total>0) readyResume(top->entries->items[top->selected]);
 			}
+			else if (PAD_justPressed(BTN_Y) && !Search_isOpen()) {
+				Search_open(screen);
+				total = top->entries->count;
+				dirty = 1;
+				if (total>0) readyResume(top->entries->items[top->selected]);
+			}
 		}
 		
 		if (dirty) {
@@ -1490,31 +2825,18 @@ int main (int argc, char *argv[]) {
 			int oy;
 			
 			// simple thumbnail support a thumbnail for a file or folder named NAME.EXT needs a corresponding /.res/NAME.EXT.png 
-			// that is no bigger than platform FIXED_HEIGHT x FIXED_HEIGHT
+			// that is ideally no bigger than platform FIXED_HEIGHT x FIXED_HEIGHT (larger ones are scaled down to fit)
 			int had_thumb = 0;
 			if (!show_version && total>0) {
-				Entry* entry = top->entries->items[top->selected];
-				char res_path[MAX_PATH];
-				
-				char res_root[MAX_PATH];
-				strcpy(res_root, entry->path);
-				
-				char tmp_path[MAX_PATH];
-				strcpy(tmp_path, entry->path);
-				char* res_name = strrchr(tmp_path, '/') + 1;
-
-				char* tmp = strrchr(res_root, '/');
-				tmp[0] = '\0';
-				
-				sprintf(res_path, "%s/.res/%s.png", res_root, res_name);
-				LOG_info("res_path: %s\n", res_path);
-				if (exists(res_path)) {
-					had_thumb = 1;
-					SDL_Surface* thumb = IMG_Load(res_path);
-					ox = MAX(FIXED_WIDTH - FIXED_HEIGHT, (FIXED_WIDTH - thumb->w));
-					oy = (FIXED_HEIGHT - thumb->h) / 2;
-					SDL_BlitSurface(thumb, NULL, screen, &(SDL_Rect){ox,oy});
-					SDL_FreeSurface(thumb);
+				SDL_Surface* thumb = Thumb_get(top, &had_thumb);
+				if (had_thumb) {
+					// still decoding, make room for the largest it could be
+					ox = FIXED_WIDTH - FIXED_HEIGHT;
+					if (thumb) {
+						ox = MAX(FIXED_WIDTH - FIXED_HEIGHT, (FIXED_WIDTH - thumb->w));
+						oy = (FIXED_HEIGHT - thumb->h) / 2;
+						SDL_BlitSurface(thumb, NULL, screen, &(SDL_Rect){ox,oy});
+					}
 				}
 			}
 			
@@ -1595,12 +2917,15 @@ int main (int argc, char *argv[]) {
 						int available_width = (had_thumb && j!=selected_row ? ox : screen->w) - SCALE1(PADDING * 2);
 						if (i==top->start && !(had_thumb && j!=selected_row)) available_width -= ow; // 
 					
-						SDL_Color text_color = COLOR_WHITE;
-					
 						trimSortingMeta(&entry_name);
+						if (entry_unique) trimSortingMeta(&entry_unique);
 					
-						char display_name[256];
-						int text_width = GFX_truncateText(font.large, entry_unique ? entry_unique : entry_name, display_name, available_width, SCALE1(BUTTON_PADDING*2));
+						// the first string drawn sizes the pill
+						int text_width;
+						SDL_Surface* text;
+						if (j==selected_row) text = GFX_getText(font.large, entry_unique ? entry_unique : entry_name, available_width, SCALE1(BUTTON_PADDING*2), COLOR_BLACK, &text_width);
+						else if (entry_unique) text = GFX_getText(font.large, entry_unique, available_width, SCALE1(BUTTON_PADDING*2), COLOR_DARK_TEXT, &text_width);
+						else text = GFX_getText(font.large, entry_name, available_width, SCALE1(BUTTON_PADDING*2), COLOR_WHITE, &text_width);
 						int max_width = MIN(available_width, text_width);
 						if (j==selected_row) {
 							GFX_blitPill(ASSET_WHITE_PILL, screen, &(SDL_Rect){
@@ -1609,14 +2934,8 @@ int main (int argc, char *argv[]) {
 								max_width,
 								SCALE1(PILL_SIZE)
 							});
-							text_color = COLOR_BLACK;
 						}
-						else if (entry->unique) {
-							trimSortingMeta(&entry_unique);
-							char unique_name[256];
-							GFX_truncateText(font.large, entry_unique, unique_name, available_width, SCALE1(BUTTON_PADDING*2));
-						
-							SDL_Surface* text = TTF_RenderUTF8_Blended(font.large, unique_name, COLOR_DARK_TEXT);
+						else if (entry_unique) {
 							SDL_BlitSurface(text, &(SDL_Rect){
 								0,
 								0,
@@ -1626,10 +2945,9 @@ int main (int argc, char *argv[]) {
 								SCALE1(PADDING+BUTTON_PADDING),
 								SCALE1(PADDING+(j*PILL_SIZE)+4)
 							});
-						
-							GFX_truncateText(font.large, entry_name, display_name, available_width, SCALE1(BUTTON_PADDING*2));
+							
+							text = GFX_getText(font.large, entry_name, available_width, SCALE1(BUTTON_PADDING*2), COLOR_WHITE, NULL);
 						}
-						SDL_Surface* text = TTF_RenderUTF8_Blended(font.large, display_name, text_color);
 						SDL_BlitSurface(text, &(SDL_Rect){
 							0,
 							0,
@@ -1639,16 +2957,16 @@ int main (int argc, char *argv[]) {
 							SCALE1(PADDING+BUTTON_PADDING),
 							SCALE1(PADDING+(j*PILL_SIZE)+4)
 						});
-						SDL_FreeSurface(text);
 					}
 				}
 				else {
 					// TODO: for some reason screen's dimensions end up being 0x0 in GFX_blitMessage...
-					GFX_blitMessage(font.large, "Empty folder", screen, &(SDL_Rect){0,0,screen->w,screen->h}); //, NULL);
+					GFX_blitMessage(font.large, Search_isOpen() ? "No matches" : top->loader ? "Loading..." : "Empty folder", screen, &(SDL_Rect){0,0,screen->w,screen->h}); //, NULL);
 				}
 			
 				// buttons
 				if (show_setting && !GetHDMI()) GFX_blitHardwareHints(screen, show_setting);
+				else if (Search_isOpen()) Search_blitQuery(screen);
 				else if (can_resume) GFX_blitButtonGroup((char*[]){ "X","RESUME",  NULL }, 0, screen, 0);
 				else GFX_blitButtonGroup((char*[]){ 
 					BTN_SLEEP==BTN_POWER?"POWER":"MENU",
@@ -1656,12 +2974,18 @@ int main (int argc, char *argv[]) {
 					NULL }, 0, screen, 0);
 			
 				if (total==0) {
-					if (stack->count>1) {
+					if (Search_isOpen() && strlen(search.query)>1) {
+						GFX_blitButtonGroup((char*[]){ "B","DELETE",  NULL }, 0, screen, 1);
+					}
+					else if (stack->count>1) {
 						GFX_blitButtonGroup((char*[]){ "B","BACK",  NULL }, 0, screen, 1);
 					}
 				}
 				else {
-					if (stack->count>1) {
+					if (Search_isOpen() && strlen(search.query)>1) {
+						GFX_blitButtonGroup((char*[]){ "B","DELETE", "A","OPEN", NULL }, 1, screen, 1);
+					}
+					else if (stack->count>1) {
 						GFX_blitButtonGroup((char*[]){ "B","BACK", "A","OPEN", NULL }, 1, screen, 1);
 					}
 					else {
@@ -1673,12 +2997,15 @@ int main (int argc, char *argv[]) {
 			GFX_flip(screen);
 			dirty = 0;
 		}
+		else if (!quit && !show_setting && !PAD_anyPressed()) {
+			// nothing to animate or repeat, sleep until input, a worker
+			// thread has something to show or it's time for the checks above
+			PAD_wait(IDLE_TIMEOUT);
+		}
 		else GFX_sync();
 		
-		// if (!first_draw) {
-		// 	first_draw = SDL_GetTicks();
-		// 	LOG_info("- first draw: %lu\n", first_draw - main_begin);
-		// }
+		TRACE_mark("first flip");
+		TRACE_quit(); // only the first frame is traced
 		
 		// handle HDMI change
 		static int had_hdmi = -1;
@@ -1686,6 +3013,18 @@ int main (int argc, char *argv[]) {
 		if (had_hdmi==-1) had_hdmi = has_hdmi;
 		if (has_hdmi!=had_hdmi) {
 			had_hdmi = has_hdmi;
+			
+			SDL_Surface* output = GFX_setOutput(has_hdmi);
+			if (output) {
+				screen = output;
+				
+				// row count can change with the output, keep the selection in view
+				int total = top->entries->count;
+				top->end = MIN(total, MAX(top->selected+1, top->start + MAIN_ROW_COUNT));
+				top->start = MAX(0, top->end - MAIN_ROW_COUNT);
+				dirty = 1;
+				continue;
+			}
 
 			Entry* entry = top->entries->items[top->selected];
 			LOG_info("restarting after HDMI change... (%s)\n", entry->path);
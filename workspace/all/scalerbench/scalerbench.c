@@ -0,0 +1,146 @@
+// scalerbench
+// times the kernel scaler_lookup() returns for every bpp, effect and
+// (square) multiplier against the kernel it replaced, the baseline
+// scaler.c linked in with a base_ prefix (see the makefile): plain
+// scaling against scaler_n16/n32 on a NEON platform or scaler_c16/c32
+// otherwise (both only went up to 6x) and the 16-bit effects against
+// the old scaleNx_line and scaleNx_grid, each checked for writing the
+// same pixels, plain scaling that doesn't fails the run
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
+
+#include "platform.h" // for HAS_NEON
+#include "scaler.h"
+
+#define BENCH_RUNS 200
+#define BASE_MAX_MUL 6
+
+#ifdef HAS_NEON
+void base_scaler_n16(uint32_t xmul, uint32_t ymul, void* __restrict src, void* __restrict dst, uint32_t sw, uint32_t sh, uint32_t sp, uint32_t dw, uint32_t dh, uint32_t dp);
+void base_scaler_n32(uint32_t xmul, uint32_t ymul, void* __restrict src, void* __restrict dst, uint32_t sw, uint32_t sh, uint32_t sp, uint32_t dw, uint32_t dh, uint32_t dp);
+#define base_scaler16 base_scaler_n16
+#define base_scaler32 base_scaler_n32
+#define BASE_NAME "neon"
+#else
+void base_scaler_c16(uint32_t xmul, uint32_t ymul, void* __restrict src, void* __restrict dst, uint32_t sw, uint32_t sh, uint32_t sp, uint32_t dw, uint32_t dh, uint32_t dp);
+void base_scaler_c32(uint32_t xmul, uint32_t ymul, void* __restrict src, void* __restrict dst, uint32_t sw, uint32_t sh, uint32_t sp, uint32_t dw, uint32_t dh, uint32_t dp);
+#define base_scaler16 base_scaler_c16
+#define base_scaler32 base_scaler_c32
+#define BASE_NAME "c"
+#endif
+void base_scale1x_line(void* __restrict src, void* __restrict dst, uint32_t sw, uint32_t sh, uint32_t sp, uint32_t dw, uint32_t dh, uint32_t dp);
+void base_scale2x_line(void* __restrict src, void* __restrict dst, uint32_t sw, uint32_t sh, uint32_t sp, uint32_t dw, uint32_t dh, uint32_t dp);
+void base_scale3x_line(void* __restrict src, void* __restrict dst, uint32_t sw, uint32_t sh, uint32_t sp, uint32_t dw, uint32_t dh, uint32_t dp);
+void base_scale4x_line(void* __restrict src, void* __restrict dst, uint32_t sw, uint32_t sh, uint32_t sp, uint32_t dw, uint32_t dh, uint32_t dp);
+void base_scale2x_grid(void* __restrict src, void* __restrict dst, uint32_t sw, uint32_t sh, uint32_t sp, uint32_t dw, uint32_t dh, uint32_t dp);
+void base_scale3x_grid(void* __restrict src, void* __restrict dst, uint32_t sw, uint32_t sh, uint32_t sp, uint32_t dw, uint32_t dh, uint32_t dp);
+
+static char* effect_names[] = {
+	"none",
+	"line",
+	"grid",
+};
+
+static uint64_t now(void) {
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+// the baseline kernel for bpp, effect and mul or NULL when there wasn't one,
+// plain scaling goes through base_scaler16/32 so is flagged with plain
+static scaler_t base_lookup(int bpp, int effect, uint32_t mul, int* plain) {
+	*plain = 0;
+	if (effect==EFFECT_NONE) {
+		*plain = mul<=BASE_MAX_MUL;
+		return NULL;
+	}
+	if (bpp!=16) return NULL;
+	if (effect==EFFECT_LINE) {
+		switch (mul) {
+			case 1: return base_scale1x_line;
+			case 2: return base_scale2x_line;
+			case 3: return base_scale3x_line;
+			case 4: return base_scale4x_line;
+		}
+	}
+	else if (effect==EFFECT_GRID) {
+		switch (mul) {
+			case 2: return base_scale2x_grid;
+			case 3: return base_scale3x_grid;
+		}
+	}
+	return NULL;
+}
+
+// best of BENCH_RUNS, a bench is about the kernel not the scheduler
+static int bench(scaler_t scaler, int plain, int bpp, uint32_t mul, void* src, void* dst, uint32_t sw, uint32_t sh, uint32_t sp, uint32_t dp) {
+	uint64_t best = UINT64_MAX;
+	for (int i=0; i<BENCH_RUNS; i++) {
+		uint64_t start = now();
+		if (plain && bpp==32) base_scaler32(mul,mul, src,dst, sw,sh,sp, sw*mul,sh*mul,dp);
+		else if (plain) base_scaler16(mul,mul, src,dst, sw,sh,sp, sw*mul,sh*mul,dp);
+		else scaler(src,dst, sw,sh,sp, sw*mul,sh*mul,dp);
+		uint64_t elapsed = now() - start;
+		if (elapsed<best) best = elapsed;
+	}
+	return best;
+}
+
+int main(int argc, char* argv[]) {
+	uint32_t sw = argc>2 ? atoi(argv[1]) : 240;
+	uint32_t sh = argc>2 ? atoi(argv[2]) : 160;
+	if (!sw || !sh || sw>1024 || sh>1024) {
+		fprintf(stderr, "usage: scalerbench [width height]\n");
+		return 1;
+	}
+
+	uint32_t src_size = sw * sh * 4;
+	uint32_t dst_size = src_size * SCALER_MAX_MUL * SCALER_MAX_MUL;
+	uint8_t* src = malloc(src_size);
+	uint8_t* a = malloc(dst_size);
+	uint8_t* b = malloc(dst_size);
+	if (!src || !a || !b) {
+		fprintf(stderr, "scalerbench: out of memory\n");
+		return 1;
+	}
+	srand(1);
+	for (uint32_t i=0; i<src_size; i++) src[i] = rand();
+
+	printf("# %s %ix%i against the baseline %s kernels\n", PLATFORM, sw,sh, BASE_NAME);
+	printf("bpp\teffect\tscale\tlookup_us\tbase_us\tbase/lookup\tpixels\n");
+
+	int failed = 0;
+	for (int bpp=16; bpp<=32; bpp+=16) {
+		uint32_t sp = sw * (bpp / 8);
+		for (int effect=EFFECT_NONE; effect<EFFECT_COUNT; effect++) {
+			for (uint32_t mul=1; mul<=SCALER_MAX_MUL; mul++) {
+				uint32_t dp = sp * mul;
+				int plain;
+				scaler_t base = base_lookup(bpp, effect, mul, &plain);
+
+				memset(a, 0, dst_size);
+				memset(b, 0, dst_size);
+				int lookup_us = bench(scaler_lookup(bpp, effect, mul, mul), 0, bpp, mul, src,a, sw,sh,sp, dp);
+				if (!base && !plain) {
+					printf("%i\t%s\t%ix\t%i\t-\t-\t-\n", bpp, effect_names[effect], mul, lookup_us);
+					continue;
+				}
+				int base_us = bench(base, plain, bpp, mul, src,b, sw,sh,sp, dp);
+
+				char* pixels = memcmp(a, b, dp * sh * mul) ? "differ" : "same";
+				if (plain && *pixels=='d') failed += 1;
+				printf("%i\t%s\t%ix\t%i\t%i\t%.2f\t%s\n", bpp, effect_names[effect], mul, lookup_us, base_us, lookup_us ? (double)base_us / lookup_us : 0, pixels);
+			}
+		}
+	}
+
+	free(src);
+	free(a);
+	free(b);
+	return failed ? 1 : 0;
+}
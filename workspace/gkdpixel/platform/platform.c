@@ -75,8 +75,13 @@ void PLAT_setNearestNeighbor(int enabled) {
 void PLAT_setSharpness(int sharpness) {
 	// buh
 }
+static int next_effect = EFFECT_NONE;
+static int effect_type = EFFECT_NONE;
 void PLAT_setEffect(int effect) {
-	// buh
+	next_effect = effect;
+}
+void PLAT_setEffectColor(int color) {
+	scaler_setEffectColor(color);
 }
 void PLAT_vsync(int remaining) {
 	if (remaining>0) SDL_Delay(remaining);
@@ -568,11 +573,6 @@ static inline void scale_256x224_320x238(void* __restrict src_, void* __restrict
 scaler_t PLAT_getScaler(GFX_Renderer* renderer) {
 	GFX_freeAAScaler();
 	switch (renderer->scale) {
-		case  6: return scale6x6_c16;
-		case  5: return scale5x5_c16;
-		case  4: return scale4x4_c16;
-		case  3: return scale3x3_c16;
-		case  2: return scale2x2_c16;
 		case -1: {
 			if (renderer->src_w==256 && renderer->src_h==224) {
 				// TODO: can I fudge this here to fix minarch menu scaled preview? nope.
@@ -586,11 +586,15 @@ scaler_t PLAT_getScaler(GFX_Renderer* renderer) {
 			if (renderer->src_w==160 && renderer->src_h==144) return renderer->dst_w==320 ? GFX_getAAScaler(renderer) : scale_160x144_266x240;
 			else return GFX_getAAScaler(renderer);
 		}
-		default: return scale1x1_c16;
+		default: return scaler_lookup(16, effect_type, renderer->scale, renderer->scale);
 	}
 }
 
 void PLAT_blitRenderer(GFX_Renderer* renderer) {
+	if (effect_type!=next_effect) {
+		effect_type = next_effect;
+		renderer->blit = PLAT_getScaler(renderer); // refresh the scaler
+	}
 	void* src = renderer->src + (renderer->src_y * renderer->src_p) + (renderer->src_x * FIXED_BPP);
 	void* dst = renderer->dst + (renderer->dst_y * renderer->dst_p) + (renderer->dst_x * FIXED_BPP);
 	((scaler_t)renderer->blit)(src,dst,renderer->src_w,renderer->src_h,renderer->src_p,renderer->dst_w,renderer->dst_h,renderer->dst_p);
@@ -0,0 +1,226 @@
+// linux
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/ioctl.h>
+#include <sys/mman.h>
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <errno.h>
+#include <pthread.h>
+
+#include "msettings.h"
+
+#include "defines.h"
+#include "platform.h"
+#include "api.h"
+#include "utils.h"
+
+#include "scaler.h"
+
+int on_hdmi = 0;
+
+void InitSettings(void){}
+void QuitSettings(void){}
+
+int GetBrightness(void) { return 0; }
+int GetVolume(void) { return 0; }
+
+void SetRawBrightness(int value) {}
+void SetRawVolume(int value){}
+
+void SetBrightness(int value) {}
+void SetVolume(int value) {}
+
+int GetJack(void) { return 0; }
+void SetJack(int value) {}
+
+int GetHDMI(void) { return on_hdmi; }
+void SetHDMI(int value) {}
+
+int GetMute(void) { return 0; }
+
+///////////////////////////////
+
+// DEVICE=<name> picks the panel to emulate, ROTATE=1|3 turns it into a portrait panel
+static Profile profiles[] = {
+	{"640x480",		 640, 480, 2, 6, 10},
+	{"720x720",		 720, 720, 2, 8, 40},
+	{"1024x768",	1024, 768, 3, 7,  5},
+	{"1280x720",	1280, 720, 2, 8, 40},
+	{"hdmi",		 640, 480, 2, 6, 10, .hdmi=1}, // 640x480 handheld docked to a 720p tv
+	{NULL},
+};
+Profile profile;
+
+__attribute__((constructor)) static void pickProfile(void) {
+	// FIXED_* are read before main() gets a chance to, eg. by static initializers in minui
+	char* name = getenv("DEVICE");
+	profile = profiles[0];
+	if (name) {
+		for (int i=0; profiles[i].name; i++) {
+			if (exactMatch(profiles[i].name, name)) {
+				profile = profiles[i];
+				break;
+			}
+		}
+	}
+	char* rotate = getenv("ROTATE");
+	if (rotate) profile.rotate = atoi(rotate) % 4;
+}
+
+///////////////////////////////
+
+// REPLAY=<path> feeds "<ms> <scancode> <1|0>" lines to the event queue,
+// RECORD=<path> writes the keyboard input of a session in the same format
+static struct Replay {
+	pthread_t thread;
+	FILE* in;
+	FILE* out;
+	uint32_t start;
+} replay;
+
+static void* replayInput(void* arg) {
+	char line[256];
+	while (fgets(line, sizeof(line), replay.in)) {
+		uint32_t ms;
+		int code;
+		int pressed;
+		if (sscanf(line, "%u %i %i", &ms, &code, &pressed)!=3) continue; // comments, blank lines
+
+		uint32_t now = SDL_GetTicks() - replay.start;
+		if (ms>now) SDL_Delay(ms - now);
+
+		SDL_Event event = {0};
+		event.type = pressed ? SDL_KEYDOWN : SDL_KEYUP;
+		event.key.state = pressed ? SDL_PRESSED : SDL_RELEASED;
+		event.key.keysym.scancode = code;
+		SDL_PushEvent(&event);
+	}
+	LOG_info("replay finished after %ums\n", SDL_GetTicks() - replay.start);
+	fclose(replay.in);
+	replay.in = NULL;
+	return NULL;
+}
+static int recordInput(void* userdata, SDL_Event* event) {
+	if ((event->type==SDL_KEYDOWN || event->type==SDL_KEYUP) && !event->key.repeat) {
+		fprintf(replay.out, "%u %i %i\n", SDL_GetTicks() - replay.start, event->key.keysym.scancode, event->type==SDL_KEYDOWN);
+		fflush(replay.out);
+	}
+	return 1;
+}
+
+static SDL_Joystick *joystick;
+void PLAT_initInput(void) {
+	SDL_InitSubSystem(SDL_INIT_JOYSTICK);
+	joystick = SDL_JoystickOpen(0);
+
+	replay.start = SDL_GetTicks();
+
+	char* path = getenv("RECORD");
+	if (path && (replay.out = fopen(path, "w"))) {
+		SDL_AddEventWatch(recordInput, NULL);
+	}
+
+	path = getenv("REPLAY");
+	if (path && (replay.in = fopen(path, "r"))) {
+		pthread_create(&replay.thread, NULL, replayInput, NULL);
+		pthread_detach(replay.thread);
+	}
+}
+void PLAT_quitInput(void) {
+	if (replay.out) {
+		SDL_DelEventWatch(recordInput, NULL);
+		fclose(replay.out);
+		replay.out = NULL;
+	}
+	SDL_JoystickClose(joystick);
+	SDL_QuitSubSystem(SDL_INIT_JOYSTICK);
+}
+
+///////////////////////////////
+
+SDL_Surface* PLAT_initVideo(void) {
+	LOG_info("profile: %s %ix%i rotate: %i hdmi: %i\n", profile.name, profile.width, profile.height, profile.rotate, profile.hdmi);
+
+	GFX_Device device = {
+		.width = FIXED_WIDTH,
+		.height = FIXED_HEIGHT,
+		.pitch = FIXED_PITCH,
+		.linear = profile.hdmi,
+		.hdmi = profile.hdmi,
+		.rotate = profile.rotate,
+		.tall_hard_scale = 2,
+	};
+	if (profile.hdmi) {
+		device.width = HDMI_WIDTH;
+		device.height = HDMI_HEIGHT;
+		device.pitch = HDMI_PITCH;
+		on_hdmi = 1;
+	}
+	return GFX_initDevice(&device);
+}
+
+///////////////////////////////
+
+#define OVERLAY_WIDTH PILL_SIZE // unscaled
+#define OVERLAY_HEIGHT PILL_SIZE // unscaled
+#define OVERLAY_BPP 4
+#define OVERLAY_DEPTH 16
+#define OVERLAY_PITCH (OVERLAY_WIDTH * OVERLAY_BPP) // unscaled
+#define OVERLAY_RGBA_MASK 0x00ff0000,0x0000ff00,0x000000ff,0xff000000 // ARGB
+static struct OVL_Context {
+	SDL_Surface* overlay;
+} ovl;
+
+SDL_Surface* PLAT_initOverlay(void) {
+	ovl.overlay = SDL_CreateRGBSurface(SDL_SWSURFACE, SCALE2(OVERLAY_WIDTH,OVERLAY_HEIGHT),OVERLAY_DEPTH,OVERLAY_RGBA_MASK);
+	return ovl.overlay;
+}
+void PLAT_quitOverlay(void) {
+	if (ovl.overlay) SDL_FreeSurface(ovl.overlay);
+}
+void PLAT_enableOverlay(int enable) {
+
+}
+
+///////////////////////////////
+
+void PLAT_getBatteryStatus(int* is_charging, int* charge) {
+	*is_charging = 1;
+	*charge = 100;
+}
+
+void PLAT_enableBacklight(int enable) {
+	// buh
+}
+
+void PLAT_powerOff(void) {
+	SND_quit();
+	VIB_quit();
+	PWR_quit();
+	GFX_quit();
+	exit(0);
+}
+
+///////////////////////////////
+
+void PLAT_setCPUSpeed(int speed) {
+	// leave the host governor alone
+}
+
+void PLAT_setRumble(int strength) {
+	// buh
+}
+
+int PLAT_pickSampleRate(int requested, int max) {
+	return MIN(requested, max);
+}
+
+char* PLAT_getModel(void) {
+	return "Linux";
+}
+
+int PLAT_isOnline(void) {
+	return 0;
+}
@@ -0,0 +1,163 @@
+// linux
+
+#ifndef PLATFORM_H
+#define PLATFORM_H
+
+///////////////////////////////
+
+#include "sdl.h"
+
+///////////////////////////////
+
+// picked from the DEVICE env var before main() runs, see platform.c
+typedef struct Profile {
+	char* name;
+	int width;
+	int height;
+	int scale;
+	int rows;
+	int padding;
+	int hdmi; // boots on hdmi
+	int rotate; // quarter turns, emulates a portrait panel
+} Profile;
+extern Profile profile;
+extern int on_hdmi;
+
+///////////////////////////////
+
+#define BUTTON_UP		BUTTON_NA
+#define BUTTON_DOWN		BUTTON_NA
+#define BUTTON_LEFT		BUTTON_NA
+#define BUTTON_RIGHT	BUTTON_NA
+
+#define BUTTON_SELECT	BUTTON_NA
+#define BUTTON_START	BUTTON_NA
+
+#define BUTTON_A		BUTTON_NA
+#define BUTTON_B		BUTTON_NA
+#define BUTTON_X		BUTTON_NA
+#define BUTTON_Y		BUTTON_NA
+
+#define BUTTON_L1		BUTTON_NA
+#define BUTTON_R1		BUTTON_NA
+#define BUTTON_L2		BUTTON_NA
+#define BUTTON_R2		BUTTON_NA
+#define BUTTON_L3		BUTTON_NA
+#define BUTTON_R3		BUTTON_NA
+
+#define BUTTON_MENU		BUTTON_NA
+#define BUTTON_MENU_ALT	BUTTON_NA
+#define	BUTTON_POWER	BUTTON_NA
+#define	BUTTON_PLUS		BUTTON_NA
+#define	BUTTON_MINUS	BUTTON_NA
+
+///////////////////////////////
+						// SDL_SCANCODE_*
+#define CODE_UP			82 // up
+#define CODE_DOWN		81 // down
+#define CODE_LEFT		80 // left
+#define CODE_RIGHT		79 // right
+
+#define CODE_SELECT		52 // '
+#define CODE_START		40 // return
+
+#define CODE_A			22 // s
+#define CODE_B			4  // a
+#define CODE_X			26 // w
+#define CODE_Y			20 // q
+
+#define CODE_L1			8  // e
+#define CODE_R1			21 // r
+#define CODE_L2			7  // d
+#define CODE_R2			9  // f
+#define CODE_L3			6  // c
+#define CODE_R3			25 // v
+
+#define CODE_MENU		44 // space
+#define CODE_POWER		42 // backspace
+
+#define CODE_PLUS		46 // =
+#define CODE_MINUS		45 // -
+
+///////////////////////////////
+						// xinput style pads
+#define JOY_UP			JOY_NA
+#define JOY_DOWN		JOY_NA
+#define JOY_LEFT		JOY_NA
+#define JOY_RIGHT		JOY_NA
+
+#define JOY_SELECT		6
+#define JOY_START		7
+
+#define JOY_A			1
+#define JOY_B			0
+#define JOY_X			3
+#define JOY_Y			2
+
+#define JOY_L1			4
+#define JOY_R1			5
+#define JOY_L2			JOY_NA
+#define JOY_R2			JOY_NA
+#define JOY_L3			9
+#define JOY_R3			10
+
+#define JOY_MENU		8
+#define JOY_POWER		JOY_NA
+#define JOY_PLUS		JOY_NA
+#define JOY_MINUS		JOY_NA
+
+///////////////////////////////
+
+#define AXIS_L2			2 // ABSZ
+#define AXIS_R2			5 // RABSZ
+
+#define AXIS_LX			0 // ABS_X, -30k (left) to 30k (right)
+#define AXIS_LY			1 // ABS_Y, -30k (up) to 30k (down)
+#define AXIS_RX			3 // ABS_RX, -30k (left) to 30k (right)
+#define AXIS_RY			4 // ABS_RY, -30k (up) to 30k (down)
+
+///////////////////////////////
+
+#define BTN_RESUME			BTN_X
+#define BTN_SLEEP 			BTN_POWER
+#define BTN_WAKE 			BTN_POWER
+#define BTN_MOD_VOLUME 		BTN_NONE
+#define BTN_MOD_BRIGHTNESS 	BTN_MENU
+#define BTN_MOD_PLUS 		BTN_PLUS
+#define BTN_MOD_MINUS 		BTN_MINUS
+
+///////////////////////////////
+
+#define FIXED_SCALE 	(profile.scale)
+#define FIXED_WIDTH		(profile.width)
+#define FIXED_HEIGHT	(profile.height)
+#define FIXED_BPP		2
+#define FIXED_DEPTH		(FIXED_BPP * 8)
+#define FIXED_PITCH		(FIXED_WIDTH * FIXED_BPP)
+#define FIXED_SIZE		(FIXED_PITCH * FIXED_HEIGHT)
+
+///////////////////////////////
+
+#define HAS_HDMI	1
+#define HDMI_WIDTH 	1280
+#define HDMI_HEIGHT 720
+#define HDMI_PITCH 	(HDMI_WIDTH * FIXED_BPP)
+#define HDMI_SIZE	(HDMI_PITCH * HDMI_HEIGHT)
+
+///////////////////////////////
+
+#define MAIN_ROW_COUNT (on_hdmi?8:profile.rows)
+#define PADDING (on_hdmi?40:profile.padding)
+
+///////////////////////////////
+
+#ifndef SDCARD_PATH
+#define SDCARD_PATH "./FAKESD" // override with -DSDCARD_PATH=\"...\"
+#endif
+#define MUTE_VOLUME_RAW 0
+#define USES_SDL2_VIDEO // shared video backend in api.c
+#define HAS_SCALER_HARNESS // minarch --golden, see notes.txt
+
+///////////////////////////////
+
+#endif
@@ -159,262 +159,22 @@ int PLAT_shouldWake(void) {
 	}
 	return 0;
 }
+void PLAT_waitInput(int timeout) {
+	PAD_waitFor(inputs, INPUT_COUNT, timeout);
+}
 
 ///////////////////////////////
 
-static struct VID_Context {
-	SDL_Window* window;
-	SDL_Renderer* renderer;
-	SDL_Texture* texture;
-	SDL_Texture* target;
-	SDL_Surface* buffer;
-	SDL_Surface* screen;
-	
-	GFX_Renderer* blit; // yeesh
-	
-	int width;
-	int height;
-	int pitch;
-	int sharpness;
-} vid;
-
 SDL_Surface* PLAT_initVideo(void) {
-	SDL_InitSubSystem(SDL_INIT_VIDEO);
-	SDL_ShowCursor(0);
-	
-	// SDL_version compiled;
-	// SDL_version linked;
-	// SDL_VERSION(&compiled);
-	// SDL_GetVersion(&linked);
-	// LOG_info("We compiled against SDL version %d.%d.%d ...\n", compiled.major, compiled.minor, compiled.patch);
-	// LOG_info("But we linked against SDL version %d.%d.%d.\n", linked.major, linked.minor, linked.patch);
-	
-	// LOG_info("Available video drivers:\n");
-	// for (int i=0; i<SDL_GetNumVideoDrivers(); i++) {
-	// 	LOG_info("- %s\n", SDL_GetVideoDriver(i));
-	// }
-	// LOG_info("Current video driver: %s\n", SDL_GetCurrentVideoDriver());
-	//
-	// LOG_info("Available render drivers:\n");
-	// for (int i=0; i<SDL_GetNumRenderDrivers(); i++) {
-	// 	SDL_RendererInfo info;
-	// 	SDL_GetRenderDriverInfo(i,&info);
-	// 	LOG_info("- %s\n", info.name);
-	// }
-	//
-	// LOG_info("Available display modes:\n");
-	// SDL_DisplayMode mode;
-	// for (int i=0; i<SDL_GetNumDisplayModes(0); i++) {
-	// 	SDL_GetDisplayMode(0, i, &mode);
-	// 	LOG_info("- %ix%i (%s)\n", mode.w,mode.h, SDL_GetPixelFormatName(mode.format));
-	// }
-	// SDL_GetCurrentDisplayMode(0, &mode);
-	// LOG_info("Current display mode: %ix%i (%s)\n", mode.w,mode.h, SDL_GetPixelFormatName(mode.format));
-	//
-	// LOG_info("Availabel audio drivers:\n");
-	// for (int i=0; i<SDL_GetNumAudioDrivers(); i++) {
-	// 	LOG_info("- %s\n", SDL_GetAudioDriver(i));
-	// }
-	
-	int w = FIXED_WIDTH;
-	int h = FIXED_HEIGHT;
-	int p = FIXED_PITCH;
-	
-	SDL_SetHintWithPriority(SDL_HINT_RENDER_SCALE_QUALITY, "1", SDL_HINT_OVERRIDE); // we default to soft
-	// SDL_SetHintWithPriority(SDL_HINT_RENDER_VSYNC, "1", SDL_HINT_OVERRIDE); // TODO: not doing anything
-	
-	vid.window   = SDL_CreateWindow("", SDL_WINDOWPOS_UNDEFINED, SDL_WINDOWPOS_UNDEFINED, w,h, SDL_WINDOW_SHOWN);
-	
-	// SDL_GetCurrentDisplayMode(0, &mode);
-	// LOG_info("Current display mode: %ix%i (%s)\n", mode.w,mode.h, SDL_GetPixelFormatName(mode.format));
-	
-	vid.renderer = SDL_CreateRenderer(vid.window,-1,SDL_RENDERER_ACCELERATED|SDL_RENDERER_PRESENTVSYNC);
-	// SDL_RenderSetVSync(vid.renderer, 0); // added SDL 2.0.18, m17 has 2.0.7
-	
-	// SDL_RendererInfo info;
-	// SDL_GetRendererInfo(vid.renderer, &info);
-	// LOG_info("Current render driver: %s\n", info.name);
-	
-	vid.texture = SDL_CreateTexture(vid.renderer,SDL_PIXELFORMAT_RGB565, SDL_TEXTUREACCESS_STREAMING, w,h);
-	vid.target	= NULL; // only needed for non-native sizes
-	
-	vid.buffer	= SDL_CreateRGBSurfaceFrom(NULL, w,h, FIXED_DEPTH, p, RGBA_MASK_565);
-	vid.screen	= SDL_CreateRGBSurface(SDL_SWSURFACE, w,h, FIXED_DEPTH, RGBA_MASK_565); // is this necessary any more?
-	vid.width	= w;
-	vid.height	= h;
-	vid.pitch	= p;
-	
-	vid.sharpness = SHARPNESS_SOFT;
-	
-	return vid.screen;
-}
-
-static void clearVideo(void) {
-	SDL_FillRect(vid.screen, NULL, 0);
-	for (int i=0; i<3; i++) {
-		SDL_RenderClear(vid.renderer);
-		SDL_RenderPresent(vid.renderer);
-	}
-}
-
-void PLAT_quitVideo(void) {
-	clearVideo();
-
-	SDL_FreeSurface(vid.screen);
-	SDL_FreeSurface(vid.buffer);
-	if (vid.target) SDL_DestroyTexture(vid.target);
-	SDL_DestroyTexture(vid.texture);
-	SDL_DestroyRenderer(vid.renderer);
-	SDL_DestroyWindow(vid.window);
-	SDL_Quit();
-
-	system("cat /dev/zero > /dev/fb0 2>/dev/null");
-}
-
-void PLAT_clearVideo(SDL_Surface* screen) {
-	SDL_FillRect(screen, NULL, 0); // TODO: revisit
-}
-void PLAT_clearAll(void) {
-	clearVideo();
-}
-
-void PLAT_setVsync(int vsync) {
-	
-}
-
-static int hard_scale = 4; // TODO: base src size, eg. 160x144 can be 4 o
-
-static void resizeVideo(int w, int h, int p) {
-	if (w==vid.width && h==vid.height && p==vid.pitch) return;
-	
-	if (w>=FIXED_WIDTH && h>=FIXED_HEIGHT) {
-		hard_scale = 1;
-	}
-	else if (h>=160) {
-		hard_scale = 2;
-	}
-	else {
-		hard_scale = 4;
-	}
-
-	// TODO: figure out how to ignore minarch upscale requests
-	LOG_info("resizeVideo(%i,%i,%i) hard_scale: %i\n",w,h,p, hard_scale);
-
-	SDL_FreeSurface(vid.buffer);
-	SDL_DestroyTexture(vid.texture);
-	if (vid.target) SDL_DestroyTexture(vid.target);
-	
-	SDL_SetHintWithPriority(SDL_HINT_RENDER_SCALE_QUALITY, vid.sharpness==SHARPNESS_SOFT?"1":"0", SDL_HINT_OVERRIDE);
-	vid.texture = SDL_CreateTexture(vid.renderer,SDL_PIXELFORMAT_RGB565, SDL_TEXTUREACCESS_STREAMING, w,h);
-	
-	if (vid.sharpness==SHARPNESS_CRISP) {
-		SDL_SetHintWithPriority(SDL_HINT_RENDER_SCALE_QUALITY, "1", SDL_HINT_OVERRIDE);
-		vid.target	= SDL_CreateTexture(vid.renderer,SDL_PIXELFORMAT_RGB565, SDL_TEXTUREACCESS_TARGET, w * hard_scale,h * hard_scale);
-	}
-	else {
-		vid.target = NULL;
-	}
-
-	vid.buffer	= SDL_CreateRGBSurfaceFrom(NULL, w,h, FIXED_DEPTH, p, RGBA_MASK_565);
-
-	vid.width	= w;
-	vid.height	= h;
-	vid.pitch	= p;
-}
-
-SDL_Surface* PLAT_resizeVideo(int w, int h, int p) {
-	// LOG_info("Current audio driver: %s\n", SDL_GetCurrentAudioDriver());
-	resizeVideo(w,h,p);
-	return vid.screen;
-}
-
-void PLAT_setVideoScaleClip(int x, int y, int width, int height) {
-	// buh
-}
-void PLAT_setNearestNeighbor(int enabled) {
-	// always enabled?
-}
-void PLAT_setSharpness(int sharpness) {
-	if (vid.sharpness==sharpness) return;
-	int p = vid.pitch;
-	vid.pitch = 0;
-	vid.sharpness = sharpness;
-	resizeVideo(vid.width,vid.height,p);
-}
-void PLAT_setEffect(int effect) {
-	// buh
-}
-
-void PLAT_vsync(int remaining) {
-	if (remaining>0) SDL_Delay(remaining);
-}
-
-scaler_t PLAT_getScaler(GFX_Renderer* renderer) {
-	return scale1x1_n16;
-}
-
-void PLAT_blitRenderer(GFX_Renderer* renderer) {
-	vid.blit = renderer;
-	SDL_RenderClear(vid.renderer);
-	resizeVideo(vid.blit->true_w,vid.blit->true_h,vid.blit->src_p);
-}
-
-void PLAT_flip(SDL_Surface* IGNORED, int ignored) {
-	if (!vid.blit) {
-		resizeVideo(FIXED_WIDTH,FIXED_HEIGHT,FIXED_PITCH); // !!!???
-		SDL_LockTexture(vid.texture,NULL,&vid.buffer->pixels,&vid.buffer->pitch);
-		SDL_BlitSurface(vid.screen, NULL, vid.buffer, NULL);
-		SDL_UnlockTexture(vid.texture);
-		SDL_RenderCopy(vid.renderer, vid.texture, NULL,NULL);
-		SDL_RenderPresent(vid.renderer);
-		return;
-	}
-	
-	SDL_LockTexture(vid.texture,NULL,&vid.buffer->pixels,&vid.buffer->pitch);
-	((scaler_t)vid.blit->blit)(
-		vid.blit->src,vid.buffer->pixels,
-		vid.blit->src_w,vid.blit->src_h,vid.blit->src_p,
-		// vid.blit->true_w,vid.blit->true_h,vid.blit->src_p, // TODO: fix to be confirmed, issue may not present on this platform
-		vid.buffer->w,vid.buffer->h,vid.buffer->pitch
-	);
-	SDL_UnlockTexture(vid.texture);
-	
-	SDL_Texture* target = vid.texture;
-	int w = vid.blit->src_w;
-	int h = vid.blit->src_h;
-	if (vid.sharpness==SHARPNESS_CRISP) {
-		SDL_SetRenderTarget(vid.renderer,vid.target);
-		SDL_RenderCopy(vid.renderer, vid.texture, NULL,NULL);
-		SDL_SetRenderTarget(vid.renderer,NULL);
-		w *= hard_scale;
-		h *= hard_scale;
-		target = vid.target;
-	}
-	
-	SDL_Rect* src_rect = &(SDL_Rect){0,0,w,h};
-	SDL_Rect* dst_rect = NULL;
-	if (vid.blit->aspect==0) { // native or cropped
-		int w = vid.blit->src_w * vid.blit->scale;
-		int h = vid.blit->src_h * vid.blit->scale;
-		int x = (FIXED_WIDTH - w) / 2;
-		int y = (FIXED_HEIGHT - h) / 2;
-		dst_rect = &(SDL_Rect){x,y,w,h};
-	}
-	else if (vid.blit->aspect>0) { // aspect
-		int h = FIXED_HEIGHT;
-		int w = h * vid.blit->aspect;
-		if (w>FIXED_WIDTH) {
-			double ratio = 1 / vid.blit->aspect;
-			w = FIXED_WIDTH;
-			h = w * ratio;
-		}
-		int x = (FIXED_WIDTH - w) / 2;
-		int y = (FIXED_HEIGHT - h) / 2;
-		dst_rect = &(SDL_Rect){x,y,w,h};
-	}
-	SDL_RenderCopy(vid.renderer, target, src_rect, dst_rect);
-	SDL_RenderPresent(vid.renderer);
-	vid.blit = NULL;
+	return GFX_initDevice(&(GFX_Device){
+		.width = FIXED_WIDTH,
+		.height = FIXED_HEIGHT,
+		.pitch = FIXED_PITCH,
+		.linear = 1, // we default to soft
+		.tall_hard_scale = 2,
+		.clear_on_quit = 1,
+		.present_on_clear = 1,
+	});
 }
 
 ///////////////////////////////
@@ -116,6 +116,7 @@
 
 #define SDCARD_PATH "/sdcard"
 #define MUTE_VOLUME_RAW 0
+#define USES_SDL2_VIDEO // shared video backend in api.c
 #define HAS_NEON // maybe?
 
 #define MAIN_ROW_COUNT 7
@@ -114,6 +114,7 @@
 
 #define SDCARD_PATH "/storage/TF2"
 #define MUTE_VOLUME_RAW 0
+#define USES_SDL2_VIDEO // shared video backend in api.c
 #define HAS_NEON
 #define SAMPLES 400 // fix for (most) fceumm underruns, not super helpful here
 
@@ -69,8 +69,9 @@ static inline void FlushCacheNeeded(void* pixels, uint32_t pitch, uint32_t y, ui
 //		rotate : 1 = 90 / 2 = 180 / 3 = 270
 //		mirror : 1 = Horizontal / 2 = Vertical / 3 = Both
 //		nowait : 0 = wait until done / 1 = no wait
+//		returns the fence to MI_GFX_WaitAllDone() on when nowait
 //
-static inline void GFX_BlitSurfaceExec(SDL_Surface *src, SDL_Rect *srcrect, SDL_Surface *dst, SDL_Rect *dstrect, uint32_t rotate, uint32_t mirror, uint32_t nowait) {
+static inline MI_U16 GFX_BlitSurfaceExec(SDL_Surface *src, SDL_Rect *srcrect, SDL_Surface *dst, SDL_Rect *dstrect, uint32_t rotate, uint32_t mirror, uint32_t nowait) {
 	if ((src)&&(dst)&&(src->pixelsPa)&&(dst->pixelsPa)) {
 		MI_GFX_Surface_t Src;
 		MI_GFX_Surface_t Dst;
@@ -147,7 +148,9 @@ static inline void GFX_BlitSurfaceExec(SDL_Surface *src, SDL_Rect *srcrect, SDL_
 
 		MI_GFX_BitBlit(&Src, &SrcRect, &Dst, &DstRect, &Opt, &Fence);
 		if (!nowait) MI_GFX_WaitAllDone(FALSE, Fence);
+		return Fence;
 	} else SDL_BlitSurface(src, srcrect, dst, dstrect);
+	return 0;
 }
 
 ///////////////////////////////
@@ -234,7 +237,9 @@ SDL_Surface* PLAT_initVideo(void) {
 	return vid.direct ? vid.video : vid.screen;
 }
 
+static void BLT_free(void);
 void PLAT_quitVideo(void) {
+	BLT_free();
 	SDL_FreeSurface(vid.screen);
 	
 	MI_SYS_Munmap(vid.buffer.vadd, ALIGN4K(PAGE_SIZE));
@@ -314,35 +319,207 @@ void PLAT_setSharpness(int sharpness) {
 void PLAT_setEffect(int effect) {
 	next_effect = effect;
 }
+void PLAT_setEffectColor(int color) {
+	scaler_setEffectColor(color);
+}
 
 void PLAT_vsync(int remaining) {
 	if (remaining>0) SDL_Delay(remaining);
 }
 
 scaler_t PLAT_getScaler(GFX_Renderer* renderer) {
-	if (effect_type==EFFECT_LINE) {
-		switch (renderer->scale) {
-			case 4:  return scale4x_line;
-			case 3:  return scale3x_line;
-			case 2:  return scale2x_line;
-			default: return scale1x_line;
+	int effect = effect_type>=EFFECT_NONE ? effect_type : EFFECT_NONE;
+	return scaler_lookup(16, effect, renderer->scale, renderer->scale);
+}
+
+///////////////////////////////
+
+// besides the neon scalers the raw core frame can be copied to a dma
+// buffer and scaled by MI_GFX on its way to the framebuffer, leaving
+// the cpu to the core while it blits. which is faster depends on the
+// core (source size, scale, how busy it keeps the cpu) so both are
+// timed for a few frames after every geometry change and the faster
+// one is kept. USERDATA_PATH/enable-hw-scaler or disable-hw-scaler
+// skip the timing
+
+#define BLIT_SAMPLES 16
+enum {
+	BLIT_SOFTWARE,
+	BLIT_HARDWARE,
+};
+static struct BLT_Context {
+	HWBuffer frame[PAGE_COUNT];
+	SDL_Surface* surface[PAGE_COUNT];
+	MI_U16 fence[PAGE_COUNT];
+	int pending[PAGE_COUNT];
+	int size; // of each frame page
+	int page;
+	SDL_Rect dst_rect;
+	
+	GFX_Renderer* renderer; // set by PLAT_blitRenderer, cleared by PLAT_flip
+	int mode; // of this frame
+	int was_hardware; // last flip, otherwise the framebuffer needs clearing around dst_rect
+	int clear; // pages of vid.video that still hold a software frame
+	
+	int forced; // -1 to time both
+	int src_w;
+	int src_h;
+	int scale;
+	double aspect;
+	int frames;
+	int choice;
+	uint64_t start;
+	uint64_t elapsed[2];
+} blt = {
+	.forced = -2, // unchecked
+};
+
+static void BLT_unmap(int count, int size) {
+	for (int i=0; i<count; i++) {
+		MI_SYS_Munmap(blt.frame[i].vadd, size);
+		MI_SYS_MMA_Free(blt.frame[i].padd);
+	}
+}
+static void BLT_free(void) {
+	MI_GFX_WaitAllDone(TRUE, 0);
+	for (int i=0; i<PAGE_COUNT; i++) {
+		if (blt.surface[i]) {
+			blt.surface[i]->pixels = NULL;
+			blt.surface[i]->pixelsPa = NULL; // otherwise custom SDL will try to free it?
+			SDL_FreeSurface(blt.surface[i]);
+			blt.surface[i] = NULL;
+		}
+		blt.pending[i] = 0;
+	}
+	if (blt.size) BLT_unmap(PAGE_COUNT, blt.size);
+	blt.size = 0;
+}
+
+static int BLT_pick(GFX_Renderer* renderer) {
+	if (blt.forced==-2) {
+		     if (exists(USERDATA_PATH "/enable-hw-scaler")) blt.forced = BLIT_HARDWARE;
+		else if (exists(USERDATA_PATH "/disable-hw-scaler")) blt.forced = BLIT_SOFTWARE;
+		else blt.forced = -1;
+	}
+	
+	if (effect_type!=EFFECT_NONE) return BLIT_SOFTWARE; // scanlines and grids are baked in by the integer scalers
+	if (blt.forced>=0) return blt.forced;
+	
+	if (renderer->src_w!=blt.src_w || renderer->src_h!=blt.src_h || renderer->scale!=blt.scale || renderer->aspect!=blt.aspect) {
+		blt.src_w = renderer->src_w;
+		blt.src_h = renderer->src_h;
+		blt.scale = renderer->scale;
+		blt.aspect = renderer->aspect;
+		blt.frames = 0;
+		blt.elapsed[BLIT_SOFTWARE] = 0;
+		blt.elapsed[BLIT_HARDWARE] = 0;
+	}
+	
+	if (blt.frames>=BLIT_SAMPLES*2) return blt.choice;
+	return blt.frames % 2; // alternate between the two until both have enough samples
+}
+static void BLT_time(void) {
+	if (blt.forced>=0 || effect_type!=EFFECT_NONE || blt.frames>=BLIT_SAMPLES*2) return;
+	
+	blt.elapsed[blt.mode] += getMicroseconds() - blt.start;
+	if (++blt.frames==BLIT_SAMPLES*2) {
+		blt.choice = blt.elapsed[BLIT_HARDWARE]<=blt.elapsed[BLIT_SOFTWARE] ? BLIT_HARDWARE : BLIT_SOFTWARE;
+		LOG_info("PLAT_blitRenderer: %s (software %ius hardware %ius) for %ix%i\n",
+			blt.choice==BLIT_HARDWARE ? "hardware" : "software",
+			(int)(blt.elapsed[BLIT_SOFTWARE] / BLIT_SAMPLES),
+			(int)(blt.elapsed[BLIT_HARDWARE] / BLIT_SAMPLES),
+			blt.src_w, blt.src_h
+		);
+	}
+}
+
+static int BLT_copyFrame(GFX_Renderer* renderer) {
+	// native and cropped keep the integer scale of the software path,
+	// everything else is fit straight to the screen, fractions and all
+	int scale = MAX(renderer->scale, 1);
+	int src_w = renderer->src_w;
+	int src_h = renderer->src_h;
+	int w,h;
+	if (renderer->aspect==0) {
+		src_w = MIN(src_w, FIXED_WIDTH / scale); // forced crop doesn't shrink src_w
+		src_h = MIN(src_h, FIXED_HEIGHT / scale);
+		w = src_w * scale;
+		h = src_h * scale;
+	}
+	else if (renderer->aspect>0) {
+		h = FIXED_HEIGHT;
+		w = h * renderer->aspect;
+		if (w>FIXED_WIDTH) {
+			w = FIXED_WIDTH;
+			h = w / renderer->aspect;
+		}
+	}
+	else {
+		w = FIXED_WIDTH;
+		h = FIXED_HEIGHT;
+	}
+	blt.dst_rect = (SDL_Rect){(FIXED_WIDTH - w) / 2, (FIXED_HEIGHT - h) / 2, w, h};
+	
+	int pitch = ((src_w * FIXED_BPP) + 15) & ~15;
+	int size = ALIGN4K(pitch * src_h);
+	if (size>blt.size) {
+		BLT_free();
+		for (int i=0; i<PAGE_COUNT; i++) {
+			if (MI_SYS_MMA_Alloc(NULL, size, &blt.frame[i].padd)!=MI_SUCCESS) {
+				LOG_error("BLT_copyFrame: unable to allocate %i bytes for page %i\n", size, i);
+				BLT_unmap(i, size);
+				return 0;
+			}
+			if (MI_SYS_Mmap(blt.frame[i].padd, size, &blt.frame[i].vadd, true)!=MI_SUCCESS) {
+				LOG_error("BLT_copyFrame: unable to map page %i\n", i);
+				MI_SYS_MMA_Free(blt.frame[i].padd);
+				BLT_unmap(i, size);
+				return 0;
+			}
 		}
+		blt.size = size;
 	}
-	else if (effect_type==EFFECT_GRID) {
-		switch (renderer->scale) {
-			case 3:  return scale3x_grid;
-			case 2:  return scale2x_grid;
+	
+	// the last blit from this page may still be reading it
+	if (blt.pending[blt.page]) MI_GFX_WaitAllDone(FALSE, blt.fence[blt.page]);
+	blt.pending[blt.page] = 0;
+	
+	SDL_Surface* surface = blt.surface[blt.page];
+	if (!surface || surface->w!=src_w || surface->h!=src_h || surface->pitch!=pitch) {
+		if (surface) {
+			surface->pixels = NULL;
+			surface->pixelsPa = NULL;
+			SDL_FreeSurface(surface);
 		}
+		surface = SDL_CreateRGBSurfaceFrom(blt.frame[blt.page].vadd,src_w,src_h,FIXED_DEPTH,pitch,RGBA_MASK_AUTO);
+		surface->pixelsPa = blt.frame[blt.page].padd;
+		blt.surface[blt.page] = surface;
 	}
 	
-	switch (renderer->scale) {
-		case 6:  return scale6x6_n16;
-		case 5:  return scale5x5_n16;
-		case 4:  return scale4x4_n16;
-		case 3:  return scale3x3_n16;
-		case 2:  return scale2x2_n16;
-		default: return scale1x1_n16;
+	uint8_t* src = renderer->src + (renderer->src_y * renderer->src_p) + (renderer->src_x * FIXED_BPP);
+	uint8_t* dst = surface->pixels;
+	int row = src_w * FIXED_BPP;
+	for (int y=0; y<src_h; y++) {
+		memcpy(dst, src, row);
+		src += renderer->src_p;
+		dst += pitch;
 	}
+	return 1;
+}
+static void BLT_flip(void) {
+	// vid.video flips between two pages and the hardware blit only
+	// covers dst_rect, so both need the software frame cleared away
+	if (!blt.was_hardware) blt.clear = 2;
+	if (blt.clear) {
+		uint64_t then = getMicroseconds();
+		MI_SYS_FlushInvCache(vid.video->pixels, ALIGN4K(vid.video->pitch * vid.video->h));
+		MI_SYS_MemsetPa(vid.video->pixelsPa, 0, vid.video->pitch * vid.video->h);
+		blt.clear -= 1;
+		blt.start += getMicroseconds() - then; // only while switching, keep it out of the timing
+	}
+	blt.fence[blt.page] = GFX_BlitSurfaceExec(blt.surface[blt.page], NULL, vid.video, &blt.dst_rect, 0,0,1);
+	blt.pending[blt.page] = 1;
+	blt.page = (blt.page + 1) % PAGE_COUNT;
 }
 
 void PLAT_blitRenderer(GFX_Renderer* renderer) {
@@ -350,13 +527,30 @@ void PLAT_blitRenderer(GFX_Renderer* renderer) {
 		effect_type = next_effect;
 		renderer->blit = PLAT_getScaler(renderer); // refresh the scaler
 	}
+	
+	blt.start = getMicroseconds();
+	blt.mode = BLT_pick(renderer);
+	blt.renderer = renderer;
+	if (blt.mode==BLIT_HARDWARE) {
+		if (BLT_copyFrame(renderer)) return;
+		
+		// out of mma, stick to the software scalers from here on
+		blt.forced = BLIT_SOFTWARE;
+		blt.mode = BLIT_SOFTWARE;
+	}
+	
 	void* dst = renderer->dst + (renderer->dst_y * renderer->dst_p) + (renderer->dst_x * FIXED_BPP);
 	((scaler_t)renderer->blit)(renderer->src,dst,renderer->src_w,renderer->src_h,renderer->src_p,renderer->dst_w,renderer->dst_h,renderer->dst_p);
 }
 
 
 void PLAT_flip(SDL_Surface* IGNORED, int sync) {
-	if (!vid.direct) GFX_BlitSurfaceExec(vid.screen, NULL, vid.video, NULL, 0,0,1); // TODO: handle aspect clipping
+	int hardware = blt.renderer && blt.mode==BLIT_HARDWARE;
+	if (hardware) BLT_flip();
+	else if (!vid.direct) GFX_BlitSurfaceExec(vid.screen, NULL, vid.video, NULL, 0,0,1); // TODO: handle aspect clipping
+	if (blt.renderer) BLT_time();
+	blt.was_hardware = hardware;
+	blt.renderer = NULL;
 	SDL_Flip(vid.video);
 	
 	// swap backbuffer
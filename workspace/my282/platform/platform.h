@@ -114,6 +114,7 @@
 
 #define SDCARD_PATH "/mnt/SDCARD"
 #define MUTE_VOLUME_RAW 0
+#define USES_SDL2_VIDEO // shared video backend in api.c
 #define HAS_NEON
 
 ///////////////////////////////
@@ -274,14 +274,40 @@ static struct VID_Context {
 	struct fb_var_screeninfo vinfo;
 	ion_alloc_info_t fb_info;
 	
+	struct VID_Layout {
+		int width;
+		int height;
+		int pitch;
+	} layout[PAGE_COUNT], scanout; // each page keeps the size it was drawn at
+	
 	int page;
 	int width;
 	int height;
 	int pitch;
-	int cleared;
+	int cleared; // mask of pages still to clear once offscreen
 } vid;
 static int _;
 
+static void setLayout(struct VID_Layout* layout) {
+	int vw = (vid.de_mem[DE_PATH_SIZE(0)/4]&0xFFFF)+1;
+	int vh = (vid.de_mem[DE_PATH_SIZE(0)/4]>>16)+1;
+	
+	vid.de_mem[DE_OVL_ISIZE(0)/4] = vid.de_mem[DE_OVL_ISIZE(2)/4] = ((layout->width-1) & 0xFFFF) | ((layout->height-1) << 16);
+	vid.de_mem[DE_OVL_SR(0)/4] = vid.de_mem[DE_OVL_SR(2)/4] = ((0x2000*layout->width/vw)&0xFFFF) | ((0x2000*layout->height/vh)<<16);
+	vid.de_mem[DE_OVL_STR(0)/4] = vid.de_mem[DE_OVL_STR(2)/4] = layout->pitch / 8;
+	vid.scanout = *layout;
+}
+static void showPage(int page) {
+	// the size changes with the page so a resize can't stretch the frame still on screen
+	struct VID_Layout* layout = &vid.layout[page];
+	if (layout->width!=vid.scanout.width || layout->height!=vid.scanout.height || layout->pitch!=vid.scanout.pitch) setLayout(layout);
+	vid.de_mem[DE_OVL_BA0(0)/4] = vid.de_mem[DE_OVL_BA0(2)/4] = (uintptr_t)(vid.fb_info.padd + page * PAGE_SIZE);
+	DE_enableLayer(vid.de_mem);
+}
+static int waitVblank(void) {
+	return ioctl(vid.fd_fb, OWLFB_WAITFORVSYNC, &_);
+}
+
 SDL_Surface* PLAT_initVideo(void) {
 	SDL_Init(SDL_INIT_VIDEO);
 	SDL_ShowCursor(0);
@@ -300,24 +326,21 @@ SDL_Surface* PLAT_initVideo(void) {
 	sinfo.disp_id = 2;
 	if (ioctl(vid.fd_fb, OWLFB_VSYNC_EVENT_EN, &sinfo)<0) fprintf(stderr, "VSYNC_EVENT_EN failed %s\n",strerror(errno));
 	
-	vid.page = 1;
 	vid.width = FIXED_WIDTH;
 	vid.height = FIXED_HEIGHT;
 	vid.pitch = FIXED_PITCH;
 	
 	vid.fb_info.size = PAGE_SIZE * PAGE_COUNT;
 	ion_alloc(vid.fd_ion, &vid.fb_info);
-
-	vid.screen = SDL_CreateRGBSurfaceFrom(vid.fb_info.vadd+PAGE_SIZE, vid.width,vid.height,FIXED_DEPTH,vid.pitch, RGBA_MASK_AUTO);
-	memset(vid.screen->pixels, 0, vid.pitch * vid.height);
+	memset(vid.fb_info.vadd, 0, vid.fb_info.size);
 	
-	int vw = (vid.de_mem[DE_PATH_SIZE(0)/4]&0xFFFF)+1;
-	int vh = (vid.de_mem[DE_PATH_SIZE(0)/4]>>16)+1;
-	
-	vid.de_mem[DE_OVL_ISIZE(0)/4] = vid.de_mem[DE_OVL_ISIZE(2)/4] = ((vid.width-1) & 0xFFFF) | ((vid.height-1) << 16);
-	vid.de_mem[DE_OVL_SR(0)/4] = vid.de_mem[DE_OVL_SR(2)/4] = ((0x2000*vid.width/vw)&0xFFFF) | ((0x2000*vid.height/vh)<<16);
-	vid.de_mem[DE_OVL_STR(0)/4] = vid.de_mem[DE_OVL_STR(2)/4] = vid.pitch / 8;
-	vid.de_mem[DE_OVL_BA0(0)/4] = (uintptr_t)(vid.fb_info.padd + PAGE_SIZE);
+	for (int i=0; i<PAGE_COUNT; i++) {
+		vid.layout[i] = (struct VID_Layout){vid.width,vid.height,vid.pitch};
+	}
+	setLayout(&vid.layout[0]);
+	vid.page = GFX_initPages(PAGE_COUNT, showPage, waitVblank);
+
+	vid.screen = SDL_CreateRGBSurfaceFrom(vid.fb_info.vadd + vid.page*PAGE_SIZE, vid.width,vid.height,FIXED_DEPTH,vid.pitch, RGBA_MASK_AUTO);
 	
 	GFX_setNearestNeighbor(0); // false?  
 	
@@ -325,6 +348,7 @@ SDL_Surface* PLAT_initVideo(void) {
 }
 
 void PLAT_quitVideo(void) {
+	GFX_quitPages();
 	ion_free(vid.fd_ion, &vid.fb_info);
 	munmap(vid.de_mem, DE_SIZE);
 	close(vid.fd_mem);
@@ -340,7 +364,7 @@ void PLAT_clearVideo(SDL_Surface* screen) {
 }
 void PLAT_clearAll(void) {
 	PLAT_clearVideo(vid.screen); // clear backbuffer
-	vid.cleared = 1; // defer clearing frontbuffer until offscreen
+	vid.cleared = ((1<<PAGE_COUNT)-1) & ~(1<<vid.page); // defer clearing the rest until offscreen
 }
 
 void PLAT_setVsync(int vsync) {
@@ -356,15 +380,7 @@ SDL_Surface* PLAT_resizeVideo(int w, int h, int pitch) {
 	vid.screen = SDL_CreateRGBSurfaceFrom(vid.fb_info.vadd + vid.page*PAGE_SIZE, vid.width,vid.height,FIXED_DEPTH,vid.pitch, RGBA_MASK_AUTO);
 	memset(vid.screen->pixels, 0, vid.pitch * vid.height);
 	
-	int vw = (vid.de_mem[DE_PATH_SIZE(0)/4]&0xFFFF)+1;
-	int vh = (vid.de_mem[DE_PATH_SIZE(0)/4]>>16)+1;
-	
-	vid.de_mem[DE_OVL_ISIZE(0)/4] = vid.de_mem[DE_OVL_ISIZE(2)/4] = ((vid.width-1) & 0xFFFF) | ((vid.height-1) << 16);
-	vid.de_mem[DE_OVL_SR(0)/4] = vid.de_mem[DE_OVL_SR(2)/4] = ((0x2000*vid.width/vw)&0xFFFF) | ((0x2000*vid.height/vh)<<16);
-	vid.de_mem[DE_OVL_STR(0)/4] = vid.de_mem[DE_OVL_STR(2)/4] = vid.pitch / 8;
-	vid.de_mem[DE_OVL_BA0(0)/4] = (uintptr_t)(vid.fb_info.padd + vid.page * PAGE_SIZE);
-	
-	return vid.screen;
+	return vid.screen; // the display picks up the new size with this page
 }
 
 void PLAT_setVideoScaleClip(int x, int y, int width, int height) {
@@ -391,35 +407,17 @@ void PLAT_setSharpness(int sharpness) {
 void PLAT_setEffect(int effect) {
 	next_effect = effect;
 }
+void PLAT_setEffectColor(int color) {
+	scaler_setEffectColor(color);
+}
 
 void PLAT_vsync(int remaining) {
-	if (ioctl(vid.fd_fb, OWLFB_WAITFORVSYNC, &_)) LOG_info("OWLFB_WAITFORVSYNC failed %s\n", strerror(errno));
+	GFX_waitVblank();
 }
 
 scaler_t PLAT_getScaler(GFX_Renderer* renderer) {
-	if (effect_type==EFFECT_LINE) {
-		switch (renderer->scale) {
-			case 4:  return scale4x_line;
-			case 3:  return scale3x_line;
-			case 2:  return scale2x_line;
-			default: return scale1x_line;
-		}
-	}
-	else if (effect_type==EFFECT_GRID) {
-		switch (renderer->scale) {
-			case 3:  return scale3x_grid;
-			case 2:  return scale2x_grid;
-		}
-	}
-	
-	switch (renderer->scale) {
-		case 6:  return scale6x6_n16;
-		case 5:  return scale5x5_n16;
-		case 4:  return scale4x4_n16;
-		case 3:  return scale3x3_n16;
-		case 2:  return scale2x2_n16;
-		default: return scale1x1_n16;
-	}
+	int effect = effect_type>=EFFECT_NONE ? effect_type : EFFECT_NONE;
+	return scaler_lookup(16, effect, renderer->scale, renderer->scale);
 }
 
 void PLAT_blitRenderer(GFX_Renderer* renderer) {
@@ -432,18 +430,13 @@ void PLAT_blitRenderer(GFX_Renderer* renderer) {
 }
 
 void PLAT_flip(SDL_Surface* IGNORED, int sync) {
-	vid.de_mem[DE_OVL_BA0(0)/4] = vid.de_mem[DE_OVL_BA0(2)/4] = (uintptr_t)(vid.fb_info.padd + vid.page * PAGE_SIZE);
-	DE_enableLayer(vid.de_mem);
-
-	if (sync) PLAT_vsync(0);
-
-	// swap backbuffer
-	vid.page ^= 1;
+	vid.layout[vid.page] = (struct VID_Layout){vid.width,vid.height,vid.pitch};
+	vid.page = GFX_flipPage(sync);
 	vid.screen->pixels = vid.fb_info.vadd + vid.page * PAGE_SIZE;
 
-	if (vid.cleared) {
+	if (vid.cleared & (1<<vid.page)) {
 		PLAT_clearVideo(vid.screen);
-		vid.cleared = 0;
+		vid.cleared &= ~(1<<vid.page);
 	}
 }
 
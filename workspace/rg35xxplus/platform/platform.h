@@ -135,6 +135,7 @@ extern int on_hdmi;
 
 #define SDCARD_PATH "/mnt/sdcard"
 #define MUTE_VOLUME_RAW 0
+#define USES_SDL2_VIDEO // shared video backend in api.c
 #define HAS_NEON
 #define SAMPLES 400 // fix for (most) fceumm underruns
 
@@ -128,6 +128,7 @@
 
 #define SDCARD_PATH "/storage/roms"
 #define MUTE_VOLUME_RAW 0
+#define USES_SDL2_VIDEO // shared video backend in api.c
 #define SAMPLES 400
 
 ///////////////////////////////
@@ -134,6 +134,7 @@ extern int is_brick;
 
 #define SDCARD_PATH "/mnt/SDCARD"
 #define MUTE_VOLUME_RAW 0
+#define USES_SDL2_VIDEO // shared video backend in api.c
 
 ///////////////////////////////
 
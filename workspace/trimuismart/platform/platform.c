@@ -98,16 +98,127 @@ void ion_free(int ion_fd, ion_alloc_info_t* info) {
 	if (ioctl(ion_fd, ION_IOC_FREE, &ihd)<0) fprintf(stderr, "ION_FREE failed %s\n",strerror(errno));
 }
 
-void rotate_16bpp(void* __restrict src, void* __restrict dst, uint32_t sw, uint32_t sh, uint32_t sp, uint32_t dp) {
+//
+//	rotate 90° (to match the panel) and integer scale in a single pass
+//
+//	a strip of ROTATE_TILE source columns is transposed into cached
+//	lines first so the uncached ion page only ever sees whole rows
+//	written front to back, each line is widened once then copied scale
+//	times, source column x lands on rows (sw-1-x)*scale of dst
+//
+
+#define ROTATE_TILE 8
+static struct ROT_Context {
+	uint16_t* lines; // ROTATE_TILE transposed source columns
+	uint16_t* wide; // one line widened by scale
+	int size; // pixels per line, lines only ever use the first sh
+	int failed; // size the lines couldn't be allocated for, not retried every frame
+} rot;
+
+#ifdef HAS_NEON
+#include <arm_neon.h>
+static inline void transpose8x8_n16(uint16_t* s, int spx, uint16_t* d, int dpx) {
+	uint16x8x2_t t01 = vtrnq_u16(vld1q_u16(s + 0*spx), vld1q_u16(s + 1*spx));
+	uint16x8x2_t t23 = vtrnq_u16(vld1q_u16(s + 2*spx), vld1q_u16(s + 3*spx));
+	uint16x8x2_t t45 = vtrnq_u16(vld1q_u16(s + 4*spx), vld1q_u16(s + 5*spx));
+	uint16x8x2_t t67 = vtrnq_u16(vld1q_u16(s + 6*spx), vld1q_u16(s + 7*spx));
+	
+	uint32x4x2_t e0 = vtrnq_u32(vreinterpretq_u32_u16(t01.val[0]), vreinterpretq_u32_u16(t23.val[0])); // cols 0,4 and 2,6 of rows 0-3
+	uint32x4x2_t o0 = vtrnq_u32(vreinterpretq_u32_u16(t01.val[1]), vreinterpretq_u32_u16(t23.val[1])); // cols 1,5 and 3,7 of rows 0-3
+	uint32x4x2_t e4 = vtrnq_u32(vreinterpretq_u32_u16(t45.val[0]), vreinterpretq_u32_u16(t67.val[0])); // same for rows 4-7
+	uint32x4x2_t o4 = vtrnq_u32(vreinterpretq_u32_u16(t45.val[1]), vreinterpretq_u32_u16(t67.val[1]));
+	
+	vst1q_u16(d + 0*dpx, vreinterpretq_u16_u32(vcombine_u32(vget_low_u32(e0.val[0]),  vget_low_u32(e4.val[0]))));
+	vst1q_u16(d + 1*dpx, vreinterpretq_u16_u32(vcombine_u32(vget_low_u32(o0.val[0]),  vget_low_u32(o4.val[0]))));
+	vst1q_u16(d + 2*dpx, vreinterpretq_u16_u32(vcombine_u32(vget_low_u32(e0.val[1]),  vget_low_u32(e4.val[1]))));
+	vst1q_u16(d + 3*dpx, vreinterpretq_u16_u32(vcombine_u32(vget_low_u32(o0.val[1]),  vget_low_u32(o4.val[1]))));
+	vst1q_u16(d + 4*dpx, vreinterpretq_u16_u32(vcombine_u32(vget_high_u32(e0.val[0]), vget_high_u32(e4.val[0]))));
+	vst1q_u16(d + 5*dpx, vreinterpretq_u16_u32(vcombine_u32(vget_high_u32(o0.val[0]), vget_high_u32(o4.val[0]))));
+	vst1q_u16(d + 6*dpx, vreinterpretq_u16_u32(vcombine_u32(vget_high_u32(e0.val[1]), vget_high_u32(e4.val[1]))));
+	vst1q_u16(d + 7*dpx, vreinterpretq_u16_u32(vcombine_u32(vget_high_u32(o0.val[1]), vget_high_u32(o4.val[1]))));
+}
+#endif
+
+static void widen_16bpp(uint16_t* __restrict s, uint16_t* __restrict d, int w, int scale) {
+	int x = 0;
+#ifdef HAS_NEON
+	switch (scale) {
+		case 2: for (; x+8<=w; x+=8, d+=16) { uint16x8_t v = vld1q_u16(s+x); vst2q_u16(d, ((uint16x8x2_t){{v,v}})); } break;
+		case 3: for (; x+8<=w; x+=8, d+=24) { uint16x8_t v = vld1q_u16(s+x); vst3q_u16(d, ((uint16x8x3_t){{v,v,v}})); } break;
+		case 4: for (; x+8<=w; x+=8, d+=32) { uint16x8_t v = vld1q_u16(s+x); vst4q_u16(d, ((uint16x8x4_t){{v,v,v,v}})); } break;
+	}
+#endif
+	for (; x<w; x++) {
+		uint16_t c = s[x];
+		for (int i=0; i<scale; i++) *d++ = c;
+	}
+}
+
+// a pixel at a time straight into the page without the cached lines,
+// much slower but only used when those couldn't be allocated
+static void rotate_direct_16bpp(uint16_t* s, int spx, uint8_t* dst, int sw, int sh, int dp, int scale) {
+	for (int x=0; x<sw; x++) {
+		uint8_t* d = dst + (sw - 1 - x) * scale * dp;
+		for (int j=0; j<scale; j++, d+=dp) {
+			uint16_t* row = (uint16_t*)d;
+			for (int y=0; y<sh; y++) {
+				uint16_t c = s[y * spx + x];
+				for (int i=0; i<scale; i++) *row++ = c;
+			}
+		}
+	}
+}
+
+void rotate_16bpp(void* __restrict src, void* __restrict dst, uint32_t sw, uint32_t sh, uint32_t sp, uint32_t dp, uint32_t scale) {
 	uint16_t* s = (uint16_t*)src;
-	uint16_t* d = (uint16_t*)dst;
-	int spx = sp/FIXED_BPP;
-	int dpx = dp/FIXED_BPP;
+	int spx = sp / FIXED_BPP;
+	
+	int size = sh * scale;
+	if (size>rot.size && size!=rot.failed) {
+		free(rot.lines);
+		free(rot.wide);
+		rot.lines = malloc(ROTATE_TILE * size * sizeof(uint16_t));
+		rot.wide = malloc(size * sizeof(uint16_t));
+		rot.size = size;
+		if (!rot.lines || !rot.wide) {
+			LOG_error("rotate_16bpp: unable to allocate lines for %i pixels\n", size);
+			free(rot.lines);
+			free(rot.wide);
+			rot.lines = NULL;
+			rot.wide = NULL;
+			rot.size = 0;
+			rot.failed = size;
+		}
+	}
+	if (size>rot.size) {
+		rotate_direct_16bpp(s, spx, dst, sw, sh, dp, scale);
+		return;
+	}
 	
+	int row = sh * scale * FIXED_BPP;
+	for (int x0=0; x0<sw; x0+=ROTATE_TILE) {
+		int n = MIN(ROTATE_TILE, sw - x0);
+		int y = 0;
+#ifdef HAS_NEON
+		if (n==ROTATE_TILE) {
+			for (; y+ROTATE_TILE<=sh; y+=ROTATE_TILE) {
+				transpose8x8_n16(s + y * spx + x0, spx, rot.lines + y, sh);
+			}
+		}
+#endif
+		for (; y<sh; y++) {
+			uint16_t* line = s + y * spx + x0;
+			for (int i=0; i<n; i++) rot.lines[i * sh + y] = line[i];
+		}
 		
-	for (int y=0; y<sh; y++) {
-		for (int x=0; x<sw; x++) {
-			*(d + x * dpx + (dpx - y - 1)) = *(s + (sh-1-y) * spx + (sw-1-x));
+		for (int i=0; i<n; i++) {
+			uint16_t* line = rot.lines + i * sh;
+			if (scale>1) {
+				widen_16bpp(line, rot.wide, sh, scale);
+				line = rot.wide;
+			}
+			uint8_t* d = (uint8_t*)dst + (sw - 1 - x0 - i) * scale * dp;
+			for (int j=0; j<scale; j++, d+=dp) memcpy(d, line, row);
 		}
 	}
 }
@@ -118,7 +229,6 @@ static struct VID_Context {
 	SDL_Surface* video;
 	SDL_Surface* buffer;
 	SDL_Surface* screen;
-	SDL_Surface* special;
 	
 	GFX_Renderer* renderer;
 	
@@ -136,18 +246,42 @@ static struct VID_Context {
 	
 	int rotated_pitch;
 	int rotated_offset;
-	int source_offset;
+	
+	struct VID_Layout {
+		int width;
+		int height;
+	} layout[PAGE_COUNT], scanout; // each page keeps the size it was drawn at
 	
 	int page;
 	int width;
 	int height;
 	int pitch;
 	
-	int cleared;
-	int resized;
+	int cleared; // mask of pages still to clear once offscreen
 } vid;
 static int _;
 
+static void showPage(int page) {
+	uintptr_t addr = (uintptr_t)vid.buffer_info.padd + page * PAGE_SIZE;
+	vid.buffer_config.info.fb.addr[0] = addr;
+	vid.mem_map[OVL_V_TOP_LADD0/4] = addr;
+	
+	// the size changes with the page so a resize can't stretch the frame still on screen
+	struct VID_Layout* layout = &vid.layout[page];
+	if (layout->width!=vid.scanout.width || layout->height!=vid.scanout.height) {
+		vid.buffer_config.info.fb.size[0].width  = layout->height;
+		vid.buffer_config.info.fb.size[0].height = layout->width;
+		vid.buffer_config.info.fb.crop.width  = (int64_t)layout->height << 32;
+		vid.buffer_config.info.fb.crop.height = (int64_t)layout->width  << 32;
+		uint32_t args[4] = {0, (uintptr_t)&vid.buffer_config, 1, 0};
+		ioctl(vid.disp_fd, DISP_LAYER_SET_CONFIG, args);
+		vid.scanout = *layout;
+	}
+}
+static int waitVblank(void) {
+	return ioctl(vid.fb_fd, FBIO_WAITFORVSYNC, &_);
+}
+
 void ADC_init();
 void ADC_quit();
 
@@ -181,7 +315,6 @@ SDL_Surface* PLAT_initVideo(void) {
 	ioctl(vid.disp_fd, DISP_LAYER_SET_CONFIG, args);
 	
 	// intermediate buffer
-	vid.page = 1;
 	vid.width = FIXED_WIDTH;
 	vid.height = FIXED_HEIGHT;
 	vid.pitch = FIXED_PITCH;
@@ -194,7 +327,7 @@ SDL_Surface* PLAT_initVideo(void) {
 	vid.buffer_info.size = PAGE_SIZE * PAGE_COUNT;
 	ion_alloc(vid.ion_fd, &vid.buffer_info);
 
-	vid.buffer = SDL_CreateRGBSurfaceFrom(vid.buffer_info.vadd + vid.page * PAGE_SIZE, PAGE_HEIGHT, PAGE_WIDTH, FIXED_DEPTH, PAGE_HEIGHT*FIXED_BPP, RGBA_MASK_565);
+	vid.buffer = SDL_CreateRGBSurfaceFrom(vid.buffer_info.vadd, PAGE_HEIGHT, PAGE_WIDTH, FIXED_DEPTH, PAGE_HEIGHT*FIXED_BPP, RGBA_MASK_565);
 	vid.buffer_config.channel = SCALER_CH;
 	vid.buffer_config.layer_id = SCALER_LAYER;
 	vid.buffer_config.enable = 1;
@@ -221,6 +354,13 @@ SDL_Surface* PLAT_initVideo(void) {
 	
 	// lotta waiting for vsync...
 	ioctl(vid.fb_fd, FBIO_WAITFORVSYNC, &_);
+	
+	for (int i=0; i<PAGE_COUNT; i++) {
+		vid.layout[i] = (struct VID_Layout){vid.width,vid.height};
+	}
+	vid.scanout = vid.layout[0];
+	vid.page = GFX_initPages(PAGE_COUNT, showPage, waitVblank);
+	vid.buffer->pixels = vid.buffer_info.vadd + vid.page * PAGE_SIZE;
 	// return vid.buffer;
 	
 	// trimui's SDL pukes so much debug info
@@ -233,6 +373,7 @@ void PLAT_quitVideo(void) {
 	puts("--------------------------------"); fflush(stdout);
 
 	ADC_quit();
+	GFX_quitPages();
 	
 	ioctl(vid.fb_fd, FBIO_WAITFORVSYNC, &_);
 	
@@ -271,7 +412,7 @@ void PLAT_clearVideo(SDL_Surface* IGNORED) {
 	memset(vid.buffer->pixels, 0, PAGE_SIZE); 
 }
 void PLAT_clearAll(void) {
-	vid.cleared = 1;
+	vid.cleared = ((1<<PAGE_COUNT)-1) & ~(1<<vid.page); // defer clearing the rest until offscreen
 	PLAT_clearVideo(vid.buffer); // clear backbuffer
 }
 
@@ -289,10 +430,7 @@ SDL_Surface* PLAT_resizeVideo(int w, int h, int pitch) {
 	vid.screen = SDL_CreateRGBSurfaceFrom(vid.screen_info.vadd, vid.width, vid.height, FIXED_DEPTH, vid.pitch, RGBA_MASK_565);
 	memset(vid.screen->pixels, 0, vid.pitch * vid.height);
 
-	vid.resized = 1;
-
 	vid.rotated_pitch = 0;
-	if (vid.renderer) vid.renderer->src_w = 0;
 	return vid.screen;
 }
 
@@ -305,52 +443,42 @@ void PLAT_setNearestNeighbor(int enabled) {
 void PLAT_setSharpness(int sharpness) {
 	// buh
 }
+static int next_effect = EFFECT_NONE;
+static int effect_type = EFFECT_NONE;
+static int effect_color = 0;
 void PLAT_setEffect(int effect) {
-	// buh
+	next_effect = effect;
+}
+void PLAT_setEffectColor(int color) {
+	effect_color = color;
 }
 void PLAT_vsync(int remaining) {
-	ioctl(vid.fb_fd, FBIO_WAITFORVSYNC, &_);
+	GFX_waitVblank();
 }
 
 scaler_t PLAT_getScaler(GFX_Renderer* renderer) {
-	switch (renderer->scale) {
-		case 6:  return scale6x6_n16;
-		case 5:  return scale5x5_n16;
-		case 4:  return scale4x4_n16;
-		case 3:  return scale3x3_n16;
-		case 2:  return scale2x2_n16;
-		default: return scale1x1_n16;
-	}
+	// unused, PLAT_blitRenderer rotates and scales in one pass
+	return scaler_lookup(16, EFFECT_NONE, 1, 1);
 }
 
 void PLAT_blitRenderer(GFX_Renderer* renderer) {
+	effect_type = next_effect;
 	vid.renderer = renderer;
-	int p = ((renderer->src_h+7)/8)*8 * FIXED_BPP;
-	if (!vid.special || vid.special->w!=renderer->src_h || vid.special->h!=renderer->src_w || vid.special->pitch!=p || !vid.rotated_pitch) {
-		// LOG_info("!special:%i sp_w!=src_h:%i sp_h!=src_w:%i sp_p!=src_h*FIXED_BPP:%i !rot_p: %i\n",
-		// !vid.special, vid.special && vid.special->w!=renderer->src_h, vid.special && vid.special->h!=renderer->src_w, vid.special && vid.special->pitch!=p, !vid.rotated_pitch);
-		
-		if (vid.special) SDL_FreeSurface(vid.special);
-		
-		vid.special = SDL_CreateRGBSurface(SDL_SWSURFACE, renderer->src_h,renderer->src_w, FIXED_DEPTH,RGBA_MASK_565);
-		vid.rotated_pitch = vid.height * FIXED_BPP; // ((vid.height+7)/8)*8 * FIXED_BPP; // TODO: this should be the fix but it's not :sob:
-		vid.rotated_offset = (renderer->dst_x * vid.rotated_pitch) + (renderer->dst_y * FIXED_BPP);
-		vid.source_offset = (renderer->src_x * vid.special->pitch) + (renderer->src_y * FIXED_BPP);
-		
-		LOG_info("PLAT_blitRenderer >> src:%p dst:%p blit:%p src:%ix%i (%i) dst:%i,%i %ix%i (%i) vid: %ix%i (%i) (%i)\n",
-			vid.renderer->src,
-			vid.renderer->dst, // unused
-			vid.renderer->blit,
-
-			vid.renderer->src_w,
-			vid.renderer->src_h,
-			vid.renderer->src_p, // unused
-
-			vid.renderer->dst_x,
-			vid.renderer->dst_y,
-			vid.renderer->dst_w, // unused
-			vid.renderer->dst_h, // unused?
-			vid.renderer->dst_p, // unused
+	if (!vid.rotated_pitch) {
+		vid.rotated_pitch = vid.height * FIXED_BPP;
+		LOG_info("PLAT_blitRenderer >> src:%ix%i (%i) crop:%i,%i %ix%i dst:%i,%i scale:%i vid: %ix%i (%i) (%i)\n",
+			renderer->true_w,
+			renderer->true_h,
+			renderer->src_p,
+
+			renderer->src_x,
+			renderer->src_y,
+			renderer->src_w,
+			renderer->src_h,
+
+			renderer->dst_x,
+			renderer->dst_y,
+			renderer->scale,
 
 			vid.width,
 			vid.height,
@@ -358,36 +486,35 @@ void PLAT_blitRenderer(GFX_Renderer* renderer) {
 			vid.rotated_pitch
 		);
 	}
-	rotate_16bpp(renderer->src, vid.special->pixels, renderer->src_w,renderer->src_h,renderer->src_p,vid.special->pitch);
-	((scaler_t)renderer->blit)(vid.special->pixels + vid.source_offset, vid.buffer->pixels+vid.rotated_offset, vid.special->w,vid.special->h, vid.special->pitch, vid.renderer->dst_h, vid.renderer->dst_w,vid.rotated_pitch);
+	vid.rotated_offset = (renderer->dst_x * vid.rotated_pitch) + (renderer->dst_y * FIXED_BPP);
 	
-	// LOG_info("blit(%p,%p, %i,%i,%i, %i,%i,%i)\n", vid.special->pixels, vid.buffer->pixels+vid.rotated_offset, vid.special->w,vid.special->h, vid.special->pitch, vid.renderer->dst_h, vid.renderer->dst_w,vid.rotated_pitch);
+	// effects are baked in unrotated so lines stay horizontal on screen,
+	// whatever scale the effect didn't cover is left to rotate_16bpp
+	int scale = MAX(renderer->scale, 1);
+	void* src;
+	int src_p;
+	int fx_scale = GFX_applyEffect(renderer, effect_type, scale, effect_color, &src, &src_p);
+	scale /= fx_scale;
+	
+	int sw = renderer->src_w * fx_scale;
+	int sh = renderer->src_h * fx_scale;
+	sw = MIN(sw, (vid.width  - renderer->dst_x) / scale); // cropped sizes can overshoot by a pixel or two
+	sh = MIN(sh, (vid.height - renderer->dst_y) / scale);
+	src += (renderer->src_y * fx_scale * src_p) + (renderer->src_x * fx_scale * FIXED_BPP);
+	
+	rotate_16bpp(src, vid.buffer->pixels + vid.rotated_offset, sw,sh,src_p, vid.rotated_pitch, scale);
 }
 
 void PLAT_flip(SDL_Surface* IGNORED, int sync) {
-	if (!vid.renderer) rotate_16bpp(vid.screen->pixels, vid.buffer->pixels, vid.width, vid.height,vid.pitch,vid.height*FIXED_BPP);
-	
-	vid.buffer_config.info.fb.addr[0] = (uintptr_t)vid.buffer_info.padd + vid.page * PAGE_SIZE;
-	vid.mem_map[OVL_V_TOP_LADD0/4] = (uintptr_t)vid.buffer_info.padd + vid.page * PAGE_SIZE;
+	if (!vid.renderer) rotate_16bpp(vid.screen->pixels, vid.buffer->pixels, vid.width, vid.height,vid.pitch,vid.height*FIXED_BPP, 1);
 	
-	if (vid.resized) {
-		vid.buffer_config.info.fb.size[0].width  = vid.height;
-		vid.buffer_config.info.fb.size[0].height = vid.width;
-		vid.buffer_config.info.fb.crop.width  = (int64_t)vid.height << 32;
-		vid.buffer_config.info.fb.crop.height = (int64_t)vid.width  << 32;
-		uint32_t args[4] = {0, (uintptr_t)&vid.buffer_config, 1, 0};
-		ioctl(vid.disp_fd, DISP_LAYER_SET_CONFIG, args);
-		vid.resized = 0;
-	}
-	
-	vid.page ^= 1;
+	vid.layout[vid.page] = (struct VID_Layout){vid.width,vid.height};
+	vid.page = GFX_flipPage(sync);
 	vid.buffer->pixels = vid.buffer_info.vadd + vid.page * PAGE_SIZE;
 	
-	if (sync) PLAT_vsync(0);
-	
-	if (vid.cleared) {
+	if (vid.cleared & (1<<vid.page)) {
 		PLAT_clearVideo(vid.buffer);
-		vid.cleared = 0;
+		vid.cleared &= ~(1<<vid.page);
 	}
 	
 	vid.renderer = NULL;
@@ -109,6 +109,8 @@
 #define FIXED_PITCH		(FIXED_WIDTH * FIXED_BPP)
 #define FIXED_SIZE		(FIXED_PITCH * FIXED_HEIGHT)
 
+#define PAGE_COUNT		3 // one on screen, one waiting for vblank, one to draw into
+
 ///////////////////////////////
 
 #define SDCARD_PATH "/mnt/SDCARD"
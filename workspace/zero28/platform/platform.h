@@ -127,6 +127,7 @@
 
 #define SDCARD_PATH "/mnt/SDCARD"
 #define MUTE_VOLUME_RAW 63 // 0 unintuitively is 100% volume
+#define USES_SDL2_VIDEO // shared video backend in api.c
 #define SAMPLES 400 // fix for (most) fceumm underruns
 
 ///////////////////////////////